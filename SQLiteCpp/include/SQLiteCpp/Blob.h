@@ -0,0 +1,135 @@
+/**
+ * @file    Blob.h
+ * @ingroup SQLiteCpp
+ * @brief   Blob is used to read and write a BLOB value incrementally, without loading it whole in memory.
+ *
+ * Copyright (c) 2012-2025 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/SQLiteCppExport.h>
+#include <SQLiteCpp/Database.h>
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+// Forward declarations to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3;
+struct sqlite3_blob;
+
+namespace SQLite
+{
+
+/**
+ * @brief RAII encapsulation of a SQLite incremental BLOB I/O handle.
+ *
+ * A Blob object gives access to the BLOB stored in one column of one row,
+ * identified by its table, column and rowid, reading or writing it by chunks
+ * directly into/from a user provided buffer.
+ *
+ * Notes:
+ * - the size of the BLOB cannot be changed through this handle (use an UPDATE with zeroblob() first)
+ * - if the row is modified or deleted, the handle is "expired" and any read/write throws (SQLITE_ABORT)
+ *
+ * See also the official documentation: https://www.sqlite.org/c3ref/blob_open.html
+ */
+class SQLITECPP_API Blob
+{
+public:
+    /**
+     * @brief Open a handle to the BLOB located in the given table, column and row.
+     *
+     * The database name is "main" for the main database, "temp" for the temporary database,
+     * or the name specified after the AS keyword in an ATTACH statement for an attached database.
+     *
+     * Exception is thrown in case of error, then the Blob object is NOT constructed.
+     *
+     * @param[in] aDatabase         Database connection
+     * @param[in] apTableName       Name of the table containing the BLOB
+     * @param[in] apColumnName      Name of the column containing the BLOB
+     * @param[in] aRowId            Rowid of the row containing the BLOB
+     * @param[in] abReadWrite       Open the BLOB for read and write access (default is read-only)
+     * @param[in] apDatabaseName    Database name
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    Blob(Database&   aDatabase,
+         const char* apTableName,
+         const char* apColumnName,
+         int64_t     aRowId,
+         bool        abReadWrite = false,
+         const char* apDatabaseName = "main");
+
+    /**
+     * @brief Open a handle to the BLOB located in the given table, column and row of the main database.
+     *
+     * @param[in] aDatabase         Database connection
+     * @param[in] aTableName        Name of the table containing the BLOB
+     * @param[in] aColumnName       Name of the column containing the BLOB
+     * @param[in] aRowId            Rowid of the row containing the BLOB
+     * @param[in] abReadWrite       Open the BLOB for read and write access (default is read-only)
+     *
+     * @throw SQLite::Exception in case of error
+     */
+    Blob(Database&          aDatabase,
+         const std::string& aTableName,
+         const std::string& aColumnName,
+         int64_t            aRowId,
+         bool               abReadWrite = false);
+
+    // Blob is non-copyable
+    Blob(const Blob&) = delete;
+    Blob& operator=(const Blob&) = delete;
+
+    /// Return the size in bytes of the BLOB
+    int getBytes() const noexcept;
+
+    /**
+     * @brief Read aSize bytes of the BLOB, starting at aOffset, into apBuffer
+     *
+     * @param[out] apBuffer   Destination buffer, at least aSize bytes long
+     * @param[in]  aSize      Number of bytes to read
+     * @param[in]  aOffset    Offset in the BLOB of the first byte to read
+     *
+     * @throw SQLite::Exception if the range is out of the BLOB or if the handle has expired
+     */
+    void read(void* apBuffer, int aSize, int aOffset) const;
+
+    /**
+     * @brief Write aSize bytes from apBuffer into the BLOB, starting at aOffset
+     *
+     * @param[in] apBuffer    Source buffer
+     * @param[in] aSize       Number of bytes to write
+     * @param[in] aOffset     Offset in the BLOB of the first byte to write
+     *
+     * @throw SQLite::Exception if the Blob is read-only, if the range is out of the BLOB or if the handle has expired
+     */
+    void write(const void* apBuffer, int aSize, int aOffset);
+
+    /**
+     * @brief Move the handle to the BLOB of another row of the same table and column
+     *
+     * This is faster than opening a new Blob for each row.
+     *
+     * @param[in] aRowId      Rowid of the new row
+     *
+     * @throw SQLite::Exception in case of error (the handle is then unusable)
+     */
+    void reopen(int64_t aRowId);
+
+private:
+    // Deleter functor to use with smart pointers to close the SQLite BLOB handle in an RAII fashion.
+    struct Deleter
+    {
+        void operator()(sqlite3_blob* apBlob);
+    };
+
+    sqlite3*                               mpSQLite;       ///< Pointer to SQLite Database Connection Handle (for error messages)
+    std::unique_ptr<sqlite3_blob, Deleter> mpSQLiteBlob;   ///< Pointer to SQLite BLOB Handle
+};
+
+}  // namespace SQLite
@@ -0,0 +1,93 @@
+/**
+ * @file    Blob.cpp
+ * @ingroup SQLiteCpp
+ * @brief   Blob is used to read and write a BLOB value incrementally, without loading it whole in memory.
+ *
+ * Copyright (c) 2012-2025 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <SQLiteCpp/Blob.h>
+
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h>
+
+namespace SQLite
+{
+
+// Open a BLOB handle for incremental I/O
+Blob::Blob(Database&   aDatabase,
+           const char* apTableName,
+           const char* apColumnName,
+           int64_t     aRowId,
+           bool        abReadWrite /* = false */,
+           const char* apDatabaseName /* = "main" */) :
+    mpSQLite(aDatabase.getHandle())
+{
+    sqlite3_blob* pBlob = nullptr;
+    const int ret = sqlite3_blob_open(mpSQLite, apDatabaseName, apTableName, apColumnName,
+                                      aRowId, abReadWrite ? 1 : 0, &pBlob);
+    mpSQLiteBlob.reset(pBlob);
+    if (SQLITE_OK != ret)
+    {
+        throw SQLite::Exception(mpSQLite, ret);
+    }
+}
+
+Blob::Blob(Database&          aDatabase,
+           const std::string& aTableName,
+           const std::string& aColumnName,
+           int64_t            aRowId,
+           bool               abReadWrite /* = false */) :
+    Blob(aDatabase, aTableName.c_str(), aColumnName.c_str(), aRowId, abReadWrite)
+{
+}
+
+// Return the size in bytes of the BLOB
+int Blob::getBytes() const noexcept
+{
+    return sqlite3_blob_bytes(mpSQLiteBlob.get());
+}
+
+// Read a chunk of the BLOB into the given buffer
+void Blob::read(void* apBuffer, int aSize, int aOffset) const
+{
+    const int ret = sqlite3_blob_read(mpSQLiteBlob.get(), apBuffer, aSize, aOffset);
+    if (SQLITE_OK != ret)
+    {
+        throw SQLite::Exception(mpSQLite, ret);
+    }
+}
+
+// Write a chunk of the given buffer into the BLOB
+void Blob::write(const void* apBuffer, int aSize, int aOffset)
+{
+    const int ret = sqlite3_blob_write(mpSQLiteBlob.get(), apBuffer, aSize, aOffset);
+    if (SQLITE_OK != ret)
+    {
+        throw SQLite::Exception(mpSQLite, ret);
+    }
+}
+
+// Move the BLOB handle to another row
+void Blob::reopen(int64_t aRowId)
+{
+    const int ret = sqlite3_blob_reopen(mpSQLiteBlob.get(), aRowId);
+    if (SQLITE_OK != ret)
+    {
+        throw SQLite::Exception(mpSQLite, ret);
+    }
+}
+
+// Release resource for SQLite BLOB handle
+void SQLite::Blob::Deleter::operator()(sqlite3_blob* apBlob)
+{
+    if (apBlob)
+    {
+        sqlite3_blob_close(apBlob);
+    }
+}
+
+}  // namespace SQLite
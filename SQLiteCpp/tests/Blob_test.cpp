@@ -0,0 +1,124 @@
+/**
+ * @file    Blob_test.cpp
+ * @ingroup tests
+ * @brief   Test of incremental BLOB I/O.
+ *
+ * Copyright (c) 2012-2025 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <SQLiteCpp/Blob.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <sqlite3.h> // for SQLITE_ERROR, SQLITE_READONLY and SQLITE_ABORT
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+TEST(Blob, openException)
+{
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value BLOB, msg TEXT)");
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, x'0102030405', 'first')"));
+
+    // Unknown table, column or row
+    EXPECT_THROW(SQLite::Blob blob(db, "unknown", "value", 1), SQLite::Exception);
+    EXPECT_THROW(SQLite::Blob blob(db, "test", "unknown", 1), SQLite::Exception);
+    EXPECT_THROW(SQLite::Blob blob(db, "test", "value", 2), SQLite::Exception);
+    EXPECT_THROW(SQLite::Blob blob(db, "test", "value", 1, false, "unknown"), SQLite::Exception);
+    try
+    {
+        SQLite::Blob blob(db, "test", "value", 2);
+    }
+    catch (const SQLite::Exception& e)
+    {
+        EXPECT_EQ(SQLITE_ERROR, e.getErrorCode());
+        EXPECT_STREQ("no such rowid: 2", e.what());
+    }
+}
+
+TEST(Blob, read)
+{
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value BLOB)");
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, x'0102030405')"));
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (2, x'AABB')"));
+
+    SQLite::Blob blob(db, std::string("test"), std::string("value"), 1);
+    EXPECT_EQ(5, blob.getBytes());
+
+    // Read the whole BLOB
+    unsigned char buffer[5] = {};
+    blob.read(buffer, 5, 0);
+    const unsigned char expected[5] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    EXPECT_EQ(0, memcmp(expected, buffer, sizeof(buffer)));
+
+    // Read by chunks, with an offset
+    unsigned char chunk[2] = {};
+    blob.read(chunk, 2, 3);
+    EXPECT_EQ(0x04, chunk[0]);
+    EXPECT_EQ(0x05, chunk[1]);
+
+    // Reading past the end of the BLOB is an error
+    EXPECT_THROW(blob.read(chunk, 2, 4), SQLite::Exception);
+
+    // Writing to a read-only BLOB is an error
+    EXPECT_THROW(blob.write(chunk, 1, 0), SQLite::Exception);
+
+    // Move to another row
+    blob.reopen(2);
+    EXPECT_EQ(2, blob.getBytes());
+    blob.read(chunk, 2, 0);
+    EXPECT_EQ(0xAA, chunk[0]);
+    EXPECT_EQ(0xBB, chunk[1]);
+    EXPECT_THROW(blob.reopen(3), SQLite::Exception);
+}
+
+TEST(Blob, write)
+{
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value BLOB)");
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, zeroblob(4))"));
+
+    {
+        SQLite::Blob blob(db, "test", "value", 1, true);
+        EXPECT_EQ(4, blob.getBytes());
+        const unsigned char data[2] = {0x12, 0x34};
+        blob.write(data, 2, 1);
+
+        // The size of the BLOB cannot be changed
+        EXPECT_THROW(blob.write(data, 2, 3), SQLite::Exception);
+    }
+
+    SQLite::Statement query(db, "SELECT hex(value) FROM test WHERE id = 1");
+    ASSERT_TRUE(query.executeStep());
+    EXPECT_EQ("00123400", query.getColumn(0).getString());
+}
+
+TEST(Blob, expired)
+{
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value BLOB)");
+    EXPECT_EQ(1, db.exec("INSERT INTO test VALUES (1, x'010203')"));
+
+    SQLite::Blob blob(db, "test", "value", 1);
+    EXPECT_EQ(1, db.exec("UPDATE test SET value = x'040506' WHERE id = 1"));
+
+    // The row has been modified: the handle has expired
+    unsigned char buffer[3] = {};
+    try
+    {
+        blob.read(buffer, 3, 0);
+        FAIL() << "expected an exception";
+    }
+    catch (const SQLite::Exception& e)
+    {
+        EXPECT_EQ(SQLITE_ABORT, e.getErrorCode());
+    }
+}
@@ -0,0 +1,210 @@
+#include "base64.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BASE64_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define BASE64_NEON 1
+#endif
+
+static const char b64_chars[] =
+             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+             "abcdefghijklmnopqrstuvwxyz"
+             "0123456789+/";
+
+// 3바이트 단위로 끝나지 않는 꼬리 부분까지 포함해 스칼라로 인코딩, out 에 이어씀
+static void encode_scalar_tail(const unsigned char* data, size_t len, string& out) {
+    int val = 0, valb = -6;
+    for (size_t i = 0; i < len; i++) {
+        val = (val << 8) + data[i];
+        valb += 8;
+        while (valb >= 0) {
+            out.push_back(b64_chars[(val >> valb) & 0x3F]);
+            valb -= 6;
+        }
+    }
+    if (valb > -6) out.push_back(b64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
+    while (out.size() % 4) out.push_back('=');
+}
+
+string base64_encode_scalar(const unsigned char* data, size_t len) {
+    string out;
+    out.reserve((len + 2) / 3 * 4);
+    encode_scalar_tail(data, len, out);
+    return out;
+}
+
+#ifdef BASE64_X86
+
+// Wojciech Muła 의 SSSE3 base64 알고리즘
+// 12바이트 입력을 16개의 6비트 인덱스로 펼친 뒤, 범위별 오프셋을 더해 ASCII 로 변환
+
+__attribute__((target("ssse3")))
+static inline __m128i enc_reshuffle(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("ssse3")))
+static inline __m128i enc_translate(__m128i indices) {
+    const __m128i shift_lut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+    result = _mm_shuffle_epi8(shift_lut, result);
+    return _mm_add_epi8(result, indices);
+}
+
+__attribute__((target("ssse3")))
+static string base64_encode_ssse3(const unsigned char* data, size_t len) {
+    string out;
+    out.resize((len + 2) / 3 * 4);
+    char* dst = &out[0];
+
+    size_t i = 0;
+    // 16바이트를 읽어 12바이트만 사용하므로 읽기가 버퍼를 넘지 않는 구간까지만 처리
+    for (; i + 16 <= len; i += 12) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), enc_translate(enc_reshuffle(in)));
+        dst += 16;
+    }
+
+    size_t done = dst - out.data();
+    out.resize(done);
+    encode_scalar_tail(data + i, len - i, out);
+    return out;
+}
+
+__attribute__((target("avx2")))
+static string base64_encode_avx2(const unsigned char* data, size_t len) {
+    string out;
+    out.resize((len + 2) / 3 * 4);
+    char* dst = &out[0];
+
+    const __m256i shuffle = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i shift_lut = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    size_t i = 0;
+    // 각 128비트 레인에 12바이트씩, 한 번에 24바이트 입력 → 32바이트 출력
+    for (; i + 28 <= len; i += 24) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        in = _mm256_shuffle_epi8(in, shuffle);
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        result = _mm256_shuffle_epi8(shift_lut, result);
+        result = _mm256_add_epi8(result, indices);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), result);
+        dst += 32;
+    }
+
+    size_t done = dst - out.data();
+    out.resize(done);
+    encode_scalar_tail(data + i, len - i, out);
+    return out;
+}
+
+#endif // BASE64_X86
+
+#ifdef BASE64_NEON
+
+// 48바이트를 3개 레지스터로 분리 로드(vld3q) → 6비트 인덱스 4개 레지스터 → 64바이트 테이블 조회(vqtbl4q)
+static string base64_encode_neon(const unsigned char* data, size_t len) {
+    string out;
+    out.resize((len + 2) / 3 * 4);
+    char* dst = &out[0];
+
+    const uint8x16x4_t table = vld1q_u8_x4(reinterpret_cast<const uint8_t*>(b64_chars));
+    const uint8x16_t mask = vdupq_n_u8(0x3F);
+
+    size_t i = 0;
+    for (; i + 48 <= len; i += 48) {
+        uint8x16x3_t in = vld3q_u8(data + i);
+        uint8x16x4_t indices;
+        indices.val[0] = vshrq_n_u8(in.val[0], 2);
+        indices.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+        indices.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+        indices.val[3] = vandq_u8(in.val[2], mask);
+
+        uint8x16x4_t result;
+        result.val[0] = vqtbl4q_u8(table, indices.val[0]);
+        result.val[1] = vqtbl4q_u8(table, indices.val[1]);
+        result.val[2] = vqtbl4q_u8(table, indices.val[2]);
+        result.val[3] = vqtbl4q_u8(table, indices.val[3]);
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst), result);
+        dst += 64;
+    }
+
+    size_t done = dst - out.data();
+    out.resize(done);
+    encode_scalar_tail(data + i, len - i, out);
+    return out;
+}
+
+#endif // BASE64_NEON
+
+/*
+
+구현 선택 (최초 호출 시 한 번만 CPU 기능 확인)
+
+*/
+
+using EncodeFunction = string (*)(const unsigned char*, size_t);
+
+struct Base64Implementation {
+    EncodeFunction encode;
+    const char* name;
+};
+
+static Base64Implementation select_implementation() {
+#if defined(BASE64_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {base64_encode_avx2, "avx2"};
+    if (__builtin_cpu_supports("ssse3")) return {base64_encode_ssse3, "ssse3"};
+#elif defined(BASE64_NEON)
+    return {base64_encode_neon, "neon"}; // AArch64 는 NEON 필수
+#endif
+    return {base64_encode_scalar, "scalar"};
+}
+
+static const Base64Implementation& implementation() {
+    static const Base64Implementation selected = select_implementation();
+    return selected;
+}
+
+string base64_encode(const unsigned char* data, size_t len) {
+    return implementation().encode(data, len);
+}
+
+string base64_encode(const vector<unsigned char>& in) {
+    return base64_encode(in.data(), in.size());
+}
+
+const char* base64_implementation() {
+    return implementation().name;
+}
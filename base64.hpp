@@ -0,0 +1,20 @@
+// base64 인코딩 모듈
+// CPU 가 지원하면 SIMD(x86: AVX2/SSSE3, ARM64: NEON) 인코더를 사용하고, 아니면 스칼라 인코더로 처리
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+// 실행 중인 CPU 에서 가장 빠른 구현으로 인코딩
+string base64_encode(const vector<unsigned char>& in);
+string base64_encode(const unsigned char* data, size_t len);
+
+// 기존 스칼라 구현 (SIMD 미지원 CPU 용 fallback, 벤치마크 비교 기준)
+string base64_encode_scalar(const unsigned char* data, size_t len);
+
+// 선택된 구현 이름 ("avx2", "ssse3", "neon", "scalar")
+const char* base64_implementation();
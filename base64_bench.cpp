@@ -0,0 +1,87 @@
+// base64 인코더 벤치마크
+// detections 테이블이 가리키는 실제 JPEG 이미지(이미지 저장소의 파일)로 스칼라 구현과 SIMD 구현의 처리량(MB/s)을 비교
+// 사용법: ./base64_bench [DB 파일 경로 (기본 server_log.db)] [반복 횟수 (기본 20)] [이미지 최대 개수 (기본 50)] [이미지 저장소 경로 (기본 images)]
+
+#include "base64.hpp"
+#include "image_store.hpp"
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 모든 이미지를 iterations 번 인코딩하는 데 걸린 시간으로 MB/s 계산
+template <typename Encoder>
+double measure_mb_per_sec(const vector<vector<unsigned char>>& images, int iterations, Encoder encode, size_t& checksum) {
+    size_t total_bytes = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (const auto& image : images) {
+            string encoded = encode(image);
+            checksum += encoded.size() + static_cast<unsigned char>(encoded[encoded.size() / 2]);
+            total_bytes += image.size();
+        }
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return (total_bytes / (1024.0 * 1024.0)) / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    string db_file = argc > 1 ? argv[1] : "server_log.db";
+    int iterations = argc > 2 ? stoi(argv[2]) : 20;
+    int max_images = argc > 3 ? stoi(argv[3]) : 50;
+    string store_dir = argc > 4 ? argv[4] : "images";
+
+    // 이미지 본문은 DB 가 아니라 저장소에 있으므로 해시로 파일을 읽음 (migrate_images_to_store 이후 image 열은 NULL)
+    vector<vector<unsigned char>> images;
+    try {
+        SQLite::Database db(db_file, SQLite::OPEN_READONLY);
+        ImageStore store(store_dir);
+        SQLite::Statement query(db, "SELECT image_hash FROM detections WHERE image_hash IS NOT NULL LIMIT ?");
+        query.bind(1, max_images);
+        while (query.executeStep()) {
+            MappedImage image = store.open(query.getColumn(0).getString());
+            images.emplace_back(image.data(), image.data() + image.size());
+        }
+    } catch (const exception& e) {
+        cerr << "이미지 읽기 실패: " << e.what() << endl;
+        return 1;
+    }
+
+    if (images.empty()) {
+        cerr << "detections 테이블에 이미지가 없습니다: " << db_file << endl;
+        return 1;
+    }
+
+    size_t total_size = 0;
+    for (const auto& image : images) total_size += image.size();
+
+    // SIMD 결과가 스칼라 결과와 같은지 먼저 확인
+    for (const auto& image : images) {
+        if (base64_encode(image) != base64_encode_scalar(image.data(), image.size())) {
+            cerr << "인코딩 결과 불일치 (이미지 크기 " << image.size() << " 바이트)" << endl;
+            return 1;
+        }
+    }
+
+    size_t checksum = 0;
+    double scalar = measure_mb_per_sec(images, iterations, [](const vector<unsigned char>& image) {
+        return base64_encode_scalar(image.data(), image.size());
+    }, checksum);
+    double simd = measure_mb_per_sec(images, iterations, [](const vector<unsigned char>& image) {
+        return base64_encode(image);
+    }, checksum);
+
+    cout << "이미지 " << images.size() << "건, 평균 " << total_size / images.size() / 1024 << " KB, 반복 " << iterations << "회" << endl;
+    cout << fixed << setprecision(1);
+    cout << "scalar : " << setw(8) << scalar << " MB/s" << endl;
+    cout << setw(6) << left << base64_implementation() << " : " << right << setw(8) << simd << " MB/s"
+         << " (x" << setprecision(2) << simd / scalar << ")" << endl;
+    cout << "(checksum " << checksum << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include "config_cache.hpp"
+#include "logger.hpp"
+
+template <typename Update>
+void ConfigCache::publish(Update update) {
+    lock_guard<mutex> lock(update_mutex);
+    auto next = make_shared<ConfigSnapshot>(*atomic_load(&current));
+    update(*next);
+    next->version++;
+    atomic_store(&current, shared_ptr<const ConfigSnapshot>(move(next)));
+}
+
+void ConfigCache::load(DbHandle& db) {
+    vector<CrossLine> lines = select_all_data_lines(db);
+    vector<BaseLine> baseLines = select_all_data_baseLines(db);
+    publish([&](ConfigSnapshot& snapshot) {
+        snapshot.lines = move(lines);
+        snapshot.baseLines = move(baseLines);
+    });
+    LOG_INFO("설정 캐시 적재: 감지선 " << snapshot()->lines.size() << "개, 기준선 " << snapshot()->baseLines.size() << "개");
+}
+
+void ConfigCache::reload_lines(DbHandle& db) {
+    vector<CrossLine> lines = select_all_data_lines(db);
+    publish([&](ConfigSnapshot& snapshot) { snapshot.lines = move(lines); });
+}
+
+void ConfigCache::reload_baseLines(DbHandle& db) {
+    vector<BaseLine> baseLines = select_all_data_baseLines(db);
+    publish([&](ConfigSnapshot& snapshot) { snapshot.baseLines = move(baseLines); });
+}
+
+ConfigCache& config_cache() {
+    static ConfigCache cache;
+    return cache;
+}
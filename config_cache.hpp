@@ -0,0 +1,47 @@
+// 설정 테이블(lines, baseLines) 메모리 캐시 모듈
+// 두 테이블은 작고 거의 바뀌지 않으므로, 읽기 요청마다 DB 를 조회하지 않고 불변 스냅샷을 공유한다.
+// 읽는 쪽은 shared_ptr 을 원자적으로 복사해 잠금이나 DB 연결 없이 사용하고,
+// db_management 의 insert/delete 함수가 쓰기 연결에서 변경한 직후 해당 테이블을 다시 읽어 새 스냅샷으로 교체한다. (write-through)
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+#include "db_management.hpp"
+
+using namespace std;
+
+// 설정 테이블 한 시점의 내용 (만든 뒤에는 바꾸지 않음)
+struct ConfigSnapshot {
+    uint64_t version = 0;           // 교체될 때마다 1 증가
+    vector<CrossLine> lines;        // select_all_data_lines 결과 (name 순)
+    vector<BaseLine> baseLines;     // select_all_data_baseLines 결과
+};
+
+class ConfigCache {
+public:
+    ConfigCache() : current(make_shared<const ConfigSnapshot>()) {}
+
+    // 현재 스냅샷 (여러 스레드에서 동시에 호출 가능, 받은 스냅샷은 이후 교체되어도 그대로 유효)
+    shared_ptr<const ConfigSnapshot> snapshot() const { return atomic_load(&current); }
+
+    // 두 테이블을 모두 다시 읽음 (서버 시작 시)
+    void load(DbHandle& db);
+    // 변경된 테이블만 다시 읽어 교체 (변경한 쓰기 연결로 호출)
+    void reload_lines(DbHandle& db);
+    void reload_baseLines(DbHandle& db);
+
+private:
+    // 현재 스냅샷을 복사해 update 를 적용한 새 스냅샷으로 교체
+    template <typename Update>
+    void publish(Update update);
+
+    mutex update_mutex;             // 교체끼리만 직렬화 (읽기는 잠그지 않음)
+    shared_ptr<const ConfigSnapshot> current;
+};
+
+// 프로세스 전체에서 공유하는 설정 캐시
+ConfigCache& config_cache();
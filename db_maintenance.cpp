@@ -0,0 +1,117 @@
+#include "db_maintenance.hpp"
+#include "db_management.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+RetentionOptions retention_options_from_env() {
+    RetentionOptions options;
+    if (const char* value = getenv("DETECTION_RETENTION_DAYS")) {
+        int days = atoi(value);
+        if (days >= 0) {
+            options.retention_days = days;
+        } else {
+            LOG_WARN("DETECTION_RETENTION_DAYS 값이 음수여서 기본값 " << options.retention_days << "일 사용");
+        }
+    }
+    return options;
+}
+
+// ms 가 속한 파티션(UTC 하루)의 시작 시각
+static int64_t partition_start(int64_t ms) {
+    return ms - ((ms % DETECTION_PARTITION_MS) + DETECTION_PARTITION_MS) % DETECTION_PARTITION_MS;
+}
+
+DbMaintenance::DbMaintenance(DbPool& db_pool, const ImageStore& image_store, const RetentionOptions& options)
+    : db_pool(db_pool), image_store(image_store), options(options) {
+    maintenance_thread = thread(&DbMaintenance::run, this);
+}
+
+DbMaintenance::~DbMaintenance() {
+    stop();
+}
+
+void DbMaintenance::stop() {
+    {
+        lock_guard<mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_cv.notify_all();
+    if (maintenance_thread.joinable()) maintenance_thread.join();
+}
+
+bool DbMaintenance::wait_stopping(chrono::milliseconds duration) {
+    unique_lock<mutex> lock(stop_mutex);
+    return stop_cv.wait_for(lock, duration, [this] { return stopping; });
+}
+
+void DbMaintenance::run() {
+    if (options.retention_days > 0) {
+        LOG_INFO("감지 결과 보존 기간: " << options.retention_days << "일 (" << options.interval.count() << "분마다 정리)");
+    }
+    do {
+        try {
+            if (options.retention_days > 0) {
+                int deleted = expire_partitions();
+                if (deleted > 0) LOG_INFO("보존 기간이 지난 감지 결과 " << deleted << "건 삭제");
+            }
+            vacuum_free_pages();
+        } catch (const exception& e) {
+            LOG_ERROR("DB 유지보수 실패: " << e.what());
+        }
+    } while (!wait_stopping(options.interval));
+}
+
+int DbMaintenance::expire_partitions() {
+    int64_t now_ms = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    // 파티션 경계에 맞춰 오늘을 포함한 retention_days 일만 남김
+    int64_t cutoff_ms = partition_start(now_ms) - (options.retention_days - 1) * DETECTION_PARTITION_MS;
+
+    int deleted_total = 0;
+    while (true) {
+        int64_t from_ms, to_ms;
+        int deleted = 0;
+        int removed = 0;
+        {
+            DbConnection writer = db_pool.acquire_writer();
+            if (!select_oldest_ts_ms_detections(*writer, from_ms) || from_ms >= cutoff_ms) break;
+            to_ms = min(partition_start(from_ms) + DETECTION_PARTITION_MS, cutoff_ms);
+
+            vector<string> hashes;
+            {
+                SQLite::Transaction transaction(*writer);
+                hashes = delete_range_detections(*writer, from_ms, to_ms, deleted);
+                transaction.commit();
+            }
+
+            // 행을 지운 뒤에 파일 삭제 (반대 순서면 잠시 파일 없는 행이 보일 수 있음)
+            // 메타데이터 프로세스가 그사이 같은 이미지를 기록했을 수 있으므로 쓰기 잠금 안에서 참조를 다시 확인
+            removed = remove_unreferenced_images(*writer, image_store, hashes);
+        }
+        deleted_total += deleted;
+        LOG_INFO("감지 결과 파티션 삭제: " << partition_start(from_ms) << " ~ " << to_ms << " (" << deleted << "건, 파일 " << removed << "개)");
+
+        if (wait_stopping(options.vacuum_step_pause)) break;
+    }
+    return deleted_total;
+}
+
+void DbMaintenance::vacuum_free_pages() {
+    int freed_total = 0;
+    int remaining = 0;
+    while (true) {
+        int freed;
+        {
+            DbConnection writer = db_pool.acquire_writer();
+            freed = incremental_vacuum(*writer, options.vacuum_step_pages, remaining);
+        }
+        freed_total += freed;
+        // auto_vacuum 이 INCREMENTAL 이 아니면 반환되는 페이지가 없음
+        if (remaining == 0 || freed == 0) break;
+        if (wait_stopping(options.vacuum_step_pause)) break;
+    }
+    if (freed_total > 0) {
+        LOG_INFO("DB 빈 페이지 " << freed_total << "개 반환 (남은 빈 페이지 " << remaining << "개)");
+    }
+}
@@ -0,0 +1,62 @@
+// DB 유지보수 모듈
+// 보존 기간이 지난 감지 결과를 하루 단위 파티션으로 지우고, 지운 만큼 생긴 DB 빈 페이지를 조금씩 반환한다.
+// 파티션 하나(하루)를 지울 때마다 쓰기 연결을 잠깐 빌리고, incremental_vacuum 도 작은 단위로 나눠 실행하므로
+// 요청 처리나 메타데이터 프로세스의 쓰기를 오래 막지 않는다.
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "db_pool.hpp"
+#include "image_store.hpp"
+
+using namespace std;
+
+// 유지보수 설정 기본값 (환경변수 DETECTION_RETENTION_DAYS 로 보존 기간 변경, 0 이면 지우지 않음)
+const int DETECTION_RETENTION_DAYS_DEFAULT = 30;
+const chrono::minutes DB_MAINTENANCE_INTERVAL(10);               // 유지보수 주기
+const int DB_VACUUM_STEP_PAGES = 256;                            // incremental_vacuum 한 번에 반환하는 페이지 수 (4KB 페이지 기준 1MB)
+const chrono::milliseconds DB_VACUUM_STEP_PAUSE(50);             // vacuum 단계 사이 쉬는 시간 (그 사이 다른 쓰기가 끼어들 수 있음)
+
+struct RetentionOptions {
+    int retention_days = DETECTION_RETENTION_DAYS_DEFAULT;
+    chrono::minutes interval = DB_MAINTENANCE_INTERVAL;
+    int vacuum_step_pages = DB_VACUUM_STEP_PAGES;
+    chrono::milliseconds vacuum_step_pause = DB_VACUUM_STEP_PAUSE;
+};
+
+// 환경변수에서 보존 기간을 읽음 (없거나 음수면 기본값)
+RetentionOptions retention_options_from_env();
+
+// 유지보수 스레드 (생성 시 시작, 소멸 시 진행 중인 단계를 마치고 종료)
+class DbMaintenance {
+public:
+    DbMaintenance(DbPool& db_pool, const ImageStore& image_store, const RetentionOptions& options);
+    ~DbMaintenance();
+
+    DbMaintenance(const DbMaintenance&) = delete;
+    DbMaintenance& operator=(const DbMaintenance&) = delete;
+
+    void stop();
+
+private:
+    void run();
+    // 보존 기간이 지난 파티션을 오래된 것부터 하나씩 삭제, 지운 행 수를 반환
+    int expire_partitions();
+    // 빈 페이지가 없어질 때까지 vacuum 단계를 반복
+    void vacuum_free_pages();
+    // stopping 이면 바로 true, 아니면 duration 동안 대기
+    bool wait_stopping(chrono::milliseconds duration);
+
+    DbPool& db_pool;
+    const ImageStore& image_store;
+    const RetentionOptions options;
+
+    mutex stop_mutex;
+    condition_variable stop_cv;
+    bool stopping = false;
+    thread maintenance_thread;
+};
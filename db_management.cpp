@@ -1,5 +1,61 @@
 // g++ -o db_management db_management.cpp -l SQLiteCpp -l sqlite3 -std=c++17
 #include "db_management.hpp"
+#include "config_cache.hpp"
+#include "logger.hpp"
+
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+
+///////////////////////////////////////////////
+// 감지 시각 변환
+
+const int64_t KST_OFFSET_MS = 9LL * 3600 * 1000;
+
+bool parse_timestamp_ms(const string& timestamp, int64_t& epochMs) {
+    std::tm tm = {};
+    int consumed = 0;
+    int fields = sscanf(timestamp.c_str(), "%4d-%2d-%2d%n%*1[T ]%2d:%2d:%2d%n",
+                        &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &consumed, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &consumed);
+    // 날짜만 있으면 그날 0시
+    if (fields == 3) {
+        tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+    } else if (fields != 6) {
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+
+    int64_t millis = 0;
+    const char* rest = timestamp.c_str() + consumed;
+    if (*rest == '.') {
+        // 소수점 이하는 밀리초까지만 사용
+        int digits = 0;
+        for (rest++; isdigit(static_cast<unsigned char>(*rest)); rest++) {
+            if (digits++ < 3) millis = millis * 10 + (*rest - '0');
+        }
+        for (; digits < 3; digits++) millis *= 10;
+    }
+
+    // 시간대 (없으면 KST)
+    int64_t offsetMs = KST_OFFSET_MS;
+    string zone(rest);
+    if (zone == "Z" || zone == "UTC") {
+        offsetMs = 0;
+    } else if (zone.size() == 6 && (zone[0] == '+' || zone[0] == '-') && zone[3] == ':') {
+        int hours = 0, minutes = 0;
+        if (sscanf(zone.c_str() + 1, "%2d:%2d", &hours, &minutes) != 2) return false;
+        offsetMs = (hours * 60LL + minutes) * 60 * 1000 * (zone[0] == '-' ? -1 : 1);
+    } else if (!zone.empty() && zone != "KST") {
+        return false;
+    }
+
+    time_t seconds = timegm(&tm);
+    if (seconds == -1) return false;
+    epochMs = static_cast<int64_t>(seconds) * 1000 + millis - offsetMs;
+    return true;
+}
 
 ///////////////////////////////////////////////
 // Detections 테이블
@@ -10,64 +66,258 @@ void create_table_detections(SQLite::Database& db)
         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "image BLOB, "
         "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP NOT NULL)");
-    cout << "'detections' 테이블이 준비되었습니다.\n";
+    LOG_INFO("'detections' 테이블이 준비되었습니다.");
     return;
 }
 
-bool insert_data_detections(SQLite::Database& db, vector<unsigned char> image, string timestamp) {
+// 이미지를 제외한 감지 결과 조회 (id, timestamp, 이미지 크기, ts_ms, image_hash, thumb_hash, 썸네일 크기 순서)
+static const string DETECTION_REF_SELECT =
+    "SELECT id, timestamp, IFNULL(image_size, IFNULL(length(image), 0)), ts_ms, image_hash, thumb_hash, IFNULL(thumb_size, 0) FROM detections ";
+
+// (ts_ms, id) 키셋 다음부터 limit 건 (페이지 조회와 스트리밍 커서가 같은 준비된 문장을 씀)
+static const string DETECTION_REF_PAGE_SELECT =
+    DETECTION_REF_SELECT + "WHERE (ts_ms, id) > (?, ?) AND ts_ms <= ? ORDER BY ts_ms, id LIMIT ?";
+
+// DETECTION_REF_SELECT 로 조회한 행
+static DetectionRef detection_ref_from_row(SQLite::Statement& query) {
+    DetectionRef detection;
+    detection.id = query.getColumn(0).getInt64();
+    detection.timestamp = query.getColumn(1).getString();
+    detection.imageSize = query.getColumn(2).getInt();
+    detection.tsMs = query.getColumn(3).getInt64();
+    detection.imageHash = query.getColumn(4).getString();
+    detection.thumbHash = query.getColumn(5).getString();
+    detection.thumbSize = query.getColumn(6).getInt();
+    return detection;
+}
+
+vector<DetectionRef> select_refs_for_timestamp_range_detections(DbHandle& db, int64_t startMs, int64_t endMs){
+    vector<DetectionRef> detections;
     try {
-        // SQL 인젝션 방지를 위해 Prepared Statement 사용
-        SQLite::Statement query(db, "INSERT INTO detections (image, timestamp) VALUES (?, ?)");
-        query.bind(1, image.data(), image.size());
-        query.bind(2, timestamp);
-        cout << "Prepared SQL for insert: " << query.getExpandedSQL() << endl;
-        query.exec();
-        
-        cout << "데이터 추가: (시간: " << timestamp << ")" << endl;
+        auto query = db.prepare(DETECTION_REF_SELECT + "WHERE ts_ms BETWEEN ? AND ? ORDER BY ts_ms, id");
+        query->bind(1, startMs);
+        query->bind(2, endMs);
+        LOG_DEBUG("Prepared SQL for select refs: " << query->getExpandedSQL());
+        while (query->executeStep()) {
+            detections.push_back(detection_ref_from_row(*query));
+        }
     } catch (const exception& e) {
-        // 이름이 중복될 경우 (UNIQUE 제약 조건 위반) 오류가 발생할 수 있습니다.
-        cerr << "데이터 '" << timestamp << "' 추가 실패: " << e.what() << endl;
-        return false;
+        LOG_ERROR("사용자 조회 실패: " << e.what());
     }
-    return true;
+    return detections;
 }
 
-vector<Detection> select_data_for_timestamp_range_detections(SQLite::Database& db, string startTimestamp, string endTimestamp){
-    vector<Detection> detections;
+vector<DetectionRef> select_refs_page_detections(DbHandle& db, int64_t afterMs, int64_t afterId, int64_t endMs, int limit){
+    vector<DetectionRef> detections;
+    detections.reserve(limit);
     try {
-        SQLite::Statement query(db, "SELECT * FROM detections WHERE timestamp BETWEEN ? AND ? ORDER BY timestamp");
-        query.bind(1, startTimestamp);
-        query.bind(2, endTimestamp);
-        cout << "Prepared SQL for select data vector: " << query.getExpandedSQL() << endl;
-        while (query.executeStep()) {
+        // 행 값 비교는 idx_detections_ts_ms 에서 ts_ms >= afterMs 위치로 바로 탐색함
+        auto query = db.prepare(DETECTION_REF_PAGE_SELECT);
+        query->bind(1, afterMs);
+        query->bind(2, afterId);
+        query->bind(3, endMs);
+        query->bind(4, limit);
+        LOG_DEBUG("Prepared SQL for select page: " << query->getExpandedSQL());
+        while (query->executeStep()) {
+            detections.push_back(detection_ref_from_row(*query));
+        }
+    } catch (const exception& e) {
+        LOG_ERROR("사용자 조회 실패: " << e.what());
+    }
+    return detections;
+}
 
-            const unsigned char* ucharBlobData = static_cast<const unsigned char*>(query.getColumn("image").getBlob());
-            int blobSize = query.getColumn("image").getBytes();
-            vector<unsigned char> image(ucharBlobData,ucharBlobData+blobSize);
+bool select_ref_by_id_detections(DbHandle& db, int64_t id, DetectionRef& detection){
+    try {
+        auto query = db.prepare(DETECTION_REF_SELECT + "WHERE id = ?");
+        query->bind(1, id);
+        if (!query->executeStep()) return false;
+        detection = detection_ref_from_row(*query);
+        return true;
+    } catch (const exception& e) {
+        LOG_ERROR("사용자 조회 실패: " << e.what());
+    }
+    return false;
+}
 
-            string timestamp = query.getColumn("timestamp");
+vector<DetectionRef> select_refs_missing_thumbnail_detections(DbHandle& db, int64_t afterId, int limit){
+    vector<DetectionRef> detections;
+    auto query = db.prepare(DETECTION_REF_SELECT + "WHERE id > ? AND thumb_hash IS NULL ORDER BY id LIMIT ?");
+    query->bind(1, afterId);
+    query->bind(2, limit);
+    while (query->executeStep()) {
+        detections.push_back(detection_ref_from_row(*query));
+    }
+    return detections;
+}
 
-            Detection detection = {image,timestamp};
-            detections.push_back(detection);
-        }
+bool update_thumbnail_detections(DbHandle& db, int64_t id, const string& thumbHash, int thumbSize){
+    try {
+        auto query = db.prepare("UPDATE detections SET thumb_hash = ?, thumb_size = ? WHERE id = ?");
+        query->bind(1, thumbHash);
+        query->bind(2, thumbSize);
+        query->bind(3, id);
+        return query->exec() == 1;
     } catch (const exception& e) {
-        cerr << "사용자 조회 실패: " << e.what() << endl;
+        LOG_ERROR("썸네일 기록 실패 (id: " << id << "): " << e.what());
     }
-    return detections;
+    return false;
+}
+
+DetectionCursor::DetectionCursor(DbHandle& db, int64_t afterMs, int64_t afterId, int64_t endMs, int limit)
+    : query(db.prepare(DETECTION_REF_PAGE_SELECT)) {
+    query->bind(1, afterMs);
+    query->bind(2, afterId);
+    query->bind(3, endMs);
+    query->bind(4, limit);
+    LOG_DEBUG("Prepared SQL for select data cursor: " << query->getExpandedSQL());
+}
+
+bool DetectionCursor::next(DetectionRef& detection) {
+    if (!query->executeStep()) {
+        return false;
+    }
+
+    detection = detection_ref_from_row(*query);
+    return true;
+}
+
+void DetectionImageReader::open(const DetectionRef& detection) {
+    if (!detection.imageHash.empty()) {
+        mapped = store.open(detection.imageHash);
+        if (mapped.size() != static_cast<size_t>(detection.imageSize)) {
+            mapped = MappedImage();
+            throw runtime_error("이미지 파일 크기 불일치: " + detection.imageHash);
+        }
+        return;
+    }
+
+    mapped = MappedImage();
+    if (blob) {
+        try {
+            blob->reopen(detection.id);
+            return;
+        } catch (const SQLite::Exception&) {
+            // reopen 에 실패한 핸들은 다시 쓸 수 없으므로 버림
+            blob.reset();
+            throw;
+        }
+    }
+    blob = make_unique<SQLite::Blob>(db, "detections", "image", detection.id);
+}
+
+void DetectionImageReader::read(void* buffer, int size, int offset) const {
+    if (mapped.data()) {
+        memcpy(buffer, mapped.data() + offset, size);
+        return;
+    }
+    blob->read(buffer, size, offset);
 }
 
-void delete_all_data_detections(SQLite::Database& db) {
+void delete_all_data_detections(DbHandle& db, const ImageStore& store) {
     try {
-        SQLite::Statement query(db, "DELETE FROM detections");
-        cout << "Prepared SQL for delete all: " << query.getExpandedSQL() << endl;
-        int changes = query.exec();
-        cout << "테이블의 모든 데이터를 삭제했습니다. 삭제된 행 수: " << changes << endl;
+        vector<string> hashes;
+        {
+            auto query = db.prepare("SELECT image_hash FROM detections WHERE image_hash IS NOT NULL "
+                                    "UNION SELECT thumb_hash FROM detections WHERE thumb_hash IS NOT NULL");
+            while (query->executeStep()) {
+                hashes.push_back(query->getColumn(0).getString());
+            }
+        }
+
+        auto query = db.prepare("DELETE FROM detections");
+        LOG_DEBUG("Prepared SQL for delete all: " << query->getExpandedSQL());
+        int changes = query->exec();
+        LOG_INFO("테이블의 모든 데이터를 삭제했습니다. 삭제된 행 수: " << changes);
+
+        // 행을 지운 뒤에 파일 삭제 (반대 순서면 잠시 파일 없는 행이 보일 수 있음)
+        remove_unreferenced_images(db, store, hashes);
     } catch (const exception& e) {
-        cerr << "테이블 전체 삭제 실패: " << e.what() << endl;
+        LOG_ERROR("테이블 전체 삭제 실패: " << e.what());
     }
     return;
 }
 
+bool select_oldest_ts_ms_detections(DbHandle& db, int64_t& oldestMs) {
+    auto query = db.prepare("SELECT MIN(ts_ms) FROM detections");
+    if (!query->executeStep() || query->getColumn(0).isNull()) return false;
+    oldestMs = query->getColumn(0).getInt64();
+    return true;
+}
+
+vector<string> delete_range_detections(DbHandle& db, int64_t fromMs, int64_t toMs, int& deletedRows) {
+    vector<string> hashes;
+    {
+        auto query = db.prepare("SELECT image_hash FROM detections WHERE ts_ms >= ? AND ts_ms < ? AND image_hash IS NOT NULL "
+                                "UNION SELECT thumb_hash FROM detections WHERE ts_ms >= ? AND ts_ms < ? AND thumb_hash IS NOT NULL");
+        query->bind(1, fromMs);
+        query->bind(2, toMs);
+        query->bind(3, fromMs);
+        query->bind(4, toMs);
+        while (query->executeStep()) {
+            hashes.push_back(query->getColumn(0).getString());
+        }
+    }
+
+    auto query = db.prepare("DELETE FROM detections WHERE ts_ms >= ? AND ts_ms < ?");
+    query->bind(1, fromMs);
+    query->bind(2, toMs);
+    deletedRows = query->exec();
+    return hashes;
+}
+
+int remove_unreferenced_images(DbHandle& db, const ImageStore& store, const vector<string>& hashes) {
+    if (hashes.empty()) return 0;
+
+    // 쓰기 잠금을 잡은 채 참조 확인과 파일 삭제를 함 (그사이 같은 해시를 기록하려는 쪽은 잠금을 기다렸다가 파일을 다시 씀)
+    int removed = 0;
+    SQLite::Transaction transaction(db, SQLite::TransactionBehavior::IMMEDIATE);
+    auto referenced = db.prepare("SELECT EXISTS (SELECT 1 FROM detections WHERE image_hash = ?1) OR EXISTS (SELECT 1 FROM detections WHERE thumb_hash = ?1)");
+    for (const auto& hash : hashes) {
+        referenced->bind(1, hash);
+        referenced->executeStep();
+        // 같은 이미지가 다른 행에서도 쓰이면 파일을 남김
+        if (!referenced->getColumn(0).getInt() && store.remove(hash)) removed++;
+        referenced->reset();
+    }
+    transaction.commit();
+    return removed;
+}
+
+int migrate_images_to_store(DbHandle& db, const ImageStore& store, int batchSize) {
+    int moved = 0;
+    while (true) {
+        vector<DetectionRef> batch;
+        // 파일을 쓰고 해시를 기록하는 동안 보존 기간 정리가 같은 파일을 지우지 못하도록 쓰기 잠금을 먼저 잡음
+        SQLite::Transaction transaction(db, SQLite::TransactionBehavior::IMMEDIATE);
+        {
+            auto select = db.prepare("SELECT id, image FROM detections WHERE image IS NOT NULL LIMIT ?");
+            select->bind(1, batchSize);
+            while (select->executeStep()) {
+                SQLite::Column image = select->getColumn(1);
+                DetectionRef detection;
+                detection.id = select->getColumn(0).getInt64();
+                detection.imageSize = image.getBytes();
+                detection.imageHash = store.put(static_cast<const unsigned char*>(image.getBlob()), image.getBytes());
+                batch.push_back(detection);
+            }
+        }
+        if (batch.empty()) break;
+
+        for (const auto& detection : batch) {
+            auto update = db.prepare("UPDATE detections SET image_hash = ?, image_size = ?, image = NULL WHERE id = ?");
+            update->bind(1, detection.imageHash);
+            update->bind(2, detection.imageSize);
+            update->bind(3, detection.id);
+            update->exec();
+        }
+        transaction.commit();
+        moved += batch.size();
+        LOG_INFO("이미지 저장소로 이동: " << moved << "건");
+    }
+    return moved;
+}
+
 ///////////////////////////////////////////////
 // Lines 테이블
 
@@ -82,91 +332,94 @@ void create_table_lines(SQLite::Database& db){
         "mode TEXT ," // mode = "Right", "Left", "BothDirections"
         "leftMatrixNum INTEGER, "
         "rightMatrixNum INTEGER)"); 
-    cout << "'lines' 테이블이 준비되었습니다.\n";
+    LOG_INFO("'lines' 테이블이 준비되었습니다.");
     return;
 }
 
-bool insert_data_lines(SQLite::Database& db, int indexNum ,int x1, int y1, int x2, int y2, string name, string mode, int leftMatrixNum, int rightMatrixNum) {
+bool insert_data_lines(DbHandle& db, int indexNum ,int x1, int y1, int x2, int y2, string name, string mode, int leftMatrixNum, int rightMatrixNum) {
     try {
-        // SQL 인젝션 방지를 위해 Prepared Statement 사용
-        SQLite::Statement query(db, "INSERT INTO lines (indexNum, x1, y1, x2, y2, name, mode, leftMatrixNum, rightMatrixNum) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
-        query.bind(1, indexNum);
-        query.bind(2, x1);
-        query.bind(3, y1);
-        query.bind(4, x2);
-        query.bind(5, y2);
-        query.bind(6, name);
-        query.bind(7, mode);
-        query.bind(8, leftMatrixNum);
-        query.bind(9, rightMatrixNum);
-        cout << "Prepared SQL for insert: " << query.getExpandedSQL() << endl;
-        query.exec();
+        // SQL 인젝션 방지를 위해 Prepared Statement 사용 (연결별 캐시에서 재사용)
+        auto query = db.prepare("INSERT INTO lines (indexNum, x1, y1, x2, y2, name, mode, leftMatrixNum, rightMatrixNum) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        query->bind(1, indexNum);
+        query->bind(2, x1);
+        query->bind(3, y1);
+        query->bind(4, x2);
+        query->bind(5, y2);
+        query->bind(6, name);
+        query->bind(7, mode);
+        query->bind(8, leftMatrixNum);
+        query->bind(9, rightMatrixNum);
+        LOG_DEBUG("Prepared SQL for insert: " << query->getExpandedSQL());
+        query->exec();
+        config_cache().reload_lines(db);
         
-        cout << "데이터 추가: (인덱스: " << indexNum << ")" << endl;
+        LOG_INFO("데이터 추가: (인덱스: " << indexNum << ")");
     } catch (const exception& e) {
         // 이름이 중복될 경우 (UNIQUE 제약 조건 위반) 오류가 발생할 수 있습니다.
-        cerr << "데이터 '" << name << "' 추가 실패: " << e.what() << endl;
+        LOG_ERROR("데이터 '" << name << "' 추가 실패: " << e.what());
         return false;
     }
     return true;
 }
 
-vector<CrossLine> select_all_data_lines(SQLite::Database& db){
+vector<CrossLine> select_all_data_lines(DbHandle& db){
     vector<CrossLine> lines;
     try {
-        SQLite::Statement query(db, "SELECT * FROM lines ORDER BY name");
-        cout << "Prepared SQL for select data vector: " << query.getExpandedSQL() << endl;
-        while (query.executeStep()) {
+        auto query = db.prepare("SELECT * FROM lines ORDER BY name");
+        LOG_DEBUG("Prepared SQL for select data vector: " << query->getExpandedSQL());
+        while (query->executeStep()) {
 
-            int indexNum = query.getColumn("indexNum").getInt();
-            int x1 = query.getColumn("x1").getInt();
-            int y1 = query.getColumn("y1").getInt();
-            int x2 = query.getColumn("x2").getInt();
-            int y2 = query.getColumn("y2").getInt();
-            string name = query.getColumn("name");
-            string mode = query.getColumn("mode");
-            int leftMatrixNum = query.getColumn("leftMatrixNum").getInt();
-            int rightMatrixNum = query.getColumn("rightMatrixNum").getInt();
+            int indexNum = query->getColumn("indexNum").getInt();
+            int x1 = query->getColumn("x1").getInt();
+            int y1 = query->getColumn("y1").getInt();
+            int x2 = query->getColumn("x2").getInt();
+            int y2 = query->getColumn("y2").getInt();
+            string name = query->getColumn("name");
+            string mode = query->getColumn("mode");
+            int leftMatrixNum = query->getColumn("leftMatrixNum").getInt();
+            int rightMatrixNum = query->getColumn("rightMatrixNum").getInt();
 
 
             CrossLine line = {indexNum, x1, y1, x2, y2, name, mode, leftMatrixNum, rightMatrixNum};
             lines.push_back(line);
         }
     } catch (const exception& e) {
-        cerr << "사용자 조회 실패: " << e.what() << endl;
+        LOG_ERROR("사용자 조회 실패: " << e.what());
     }
     return lines;
 }
 
-bool delete_data_lines(SQLite::Database& db, int indexNum){
+bool delete_data_lines(DbHandle& db, int indexNum){
     try {
-        SQLite::Statement query(db, "DELETE FROM lines WHERE indexNum = ?");
-        query.bind(1,indexNum);
+        auto query = db.prepare("DELETE FROM lines WHERE indexNum = ?");
+        query->bind(1,indexNum);
 
-        cout << "Prepared SQL for delete one: " << query.getExpandedSQL() << endl;
-        int changes = query.exec();
-        cout << "테이블의 특정 데이터를 삭제했습니다. 삭제된 행 수: " << changes << endl;
+        LOG_DEBUG("Prepared SQL for delete one: " << query->getExpandedSQL());
+        int changes = query->exec();
+        LOG_INFO("테이블의 특정 데이터를 삭제했습니다. 삭제된 행 수: " << changes);
         if(changes == 0){
             return false;
         }
+        config_cache().reload_lines(db);
     } catch (const exception& e) {
-        cerr << "테이블 특정 데이터 삭제 실패: " << e.what() << endl;
+        LOG_ERROR("테이블 특정 데이터 삭제 실패: " << e.what());
         return false;
     }
     return true;
 }
 
-bool delete_all_data_lines(SQLite::Database& db){
+bool delete_all_data_lines(DbHandle& db){
     try {
-        SQLite::Statement query(db, "DELETE FROM lines");
-        cout << "Prepared SQL for delete all: " << query.getExpandedSQL() << endl;
-        int changes = query.exec();
-        cout << "테이블의 모든 데이터를 삭제했습니다. 삭제된 행 수: " << changes << endl;
+        auto query = db.prepare("DELETE FROM lines");
+        LOG_DEBUG("Prepared SQL for delete all: " << query->getExpandedSQL());
+        int changes = query->exec();
+        LOG_INFO("테이블의 모든 데이터를 삭제했습니다. 삭제된 행 수: " << changes);
         if(changes == 0){
             return false;
         }
+        config_cache().reload_lines(db);
     } catch (const exception& e) {
-        cerr << "테이블 전체 삭제 실패: " << e.what() << endl;
+        LOG_ERROR("테이블 전체 삭제 실패: " << e.what());
         return false;
     }
     return true;
@@ -185,53 +438,54 @@ void create_table_baseLines(SQLite::Database& db)
         "matrixNum2 INTEGER NOT NULL, "
         "x2 INTEGER NOT NULL, "
         "y2 INTEGER NOT NULL)");
-    cout << "'baseLines' 테이블이 준비되었습니다.\n";
+    LOG_INFO("'baseLines' 테이블이 준비되었습니다.");
     return;
 }
 
-vector<BaseLine> select_all_data_baseLines(SQLite::Database& db){
+vector<BaseLine> select_all_data_baseLines(DbHandle& db){
     vector<BaseLine> baseLines;
     try {
-        SQLite::Statement query(db, "SELECT * FROM baseLines");
-        cout << "Prepared SQL for select data vector: " << query.getExpandedSQL() << endl;
-        while (query.executeStep()) {
-
-            int indexNum = query.getColumn("indexNum").getInt();
-            int matrixNum1 = query.getColumn("matrixNum1").getInt();
-            int x1 = query.getColumn("x1").getInt();
-            int y1 = query.getColumn("y1").getInt();
-            int matrixNum2 = query.getColumn("matrixNum2").getInt();
-            int x2 = query.getColumn("x1").getInt();
-            int y2 = query.getColumn("y1").getInt();
+        auto query = db.prepare("SELECT * FROM baseLines");
+        LOG_DEBUG("Prepared SQL for select data vector: " << query->getExpandedSQL());
+        while (query->executeStep()) {
+
+            int indexNum = query->getColumn("indexNum").getInt();
+            int matrixNum1 = query->getColumn("matrixNum1").getInt();
+            int x1 = query->getColumn("x1").getInt();
+            int y1 = query->getColumn("y1").getInt();
+            int matrixNum2 = query->getColumn("matrixNum2").getInt();
+            int x2 = query->getColumn("x1").getInt();
+            int y2 = query->getColumn("y1").getInt();
 
             BaseLine baseLine = {indexNum, matrixNum1, x1, y1, matrixNum2, x2, y2};
             baseLines.push_back(baseLine);
         }
     } catch (const exception& e) {
-        cerr << "사용자 조회 실패: " << e.what() << endl;
+        LOG_ERROR("사용자 조회 실패: " << e.what());
     }
     return baseLines;
 }
 
-bool insert_data_baseLines(SQLite::Database& db,BaseLine baseLine){
+bool insert_data_baseLines(DbHandle& db,BaseLine baseLine){
     try {
-        // SQL 인젝션 방지를 위해 Prepared Statement 사용
-        SQLite::Statement query(db, "INSERT INTO baseLines (indexNum, matrixNum1, x1, y1, matrixNum2, x2, y2) VALUES (?, ?, ?, ?, ?, ?, ?)");
-        query.bind(1, baseLine.index);
-        query.bind(2, baseLine.matrixNum1);
-        query.bind(3, baseLine.x1);
-        query.bind(4, baseLine.y1);
-        query.bind(5, baseLine.matrixNum2);
-        query.bind(6, baseLine.x2);
-        query.bind(7, baseLine.y2);
-
-        cout << "Prepared SQL for insert: " << query.getExpandedSQL() << endl;
-        query.exec();
+        // SQL 인젝션 방지를 위해 Prepared Statement 사용 (연결별 캐시에서 재사용)
+        auto query = db.prepare("INSERT INTO baseLines (indexNum, matrixNum1, x1, y1, matrixNum2, x2, y2) VALUES (?, ?, ?, ?, ?, ?, ?)");
+        query->bind(1, baseLine.index);
+        query->bind(2, baseLine.matrixNum1);
+        query->bind(3, baseLine.x1);
+        query->bind(4, baseLine.y1);
+        query->bind(5, baseLine.matrixNum2);
+        query->bind(6, baseLine.x2);
+        query->bind(7, baseLine.y2);
+
+        LOG_DEBUG("Prepared SQL for insert: " << query->getExpandedSQL());
+        query->exec();
+        config_cache().reload_baseLines(db);
         
-        cout << "데이터 추가: (기준선 인덱스: " << baseLine.index << ")" << endl;
+        LOG_INFO("데이터 추가: (기준선 인덱스: " << baseLine.index << ")");
     } catch (const exception& e) {
         // 이름이 중복될 경우 (UNIQUE 제약 조건 위반) 오류가 발생할 수 있습니다.
-        cerr << "데이터 '" << baseLine.index << "' 추가 실패: " << e.what() << endl;
+        LOG_ERROR("데이터 '" << baseLine.index << "' 추가 실패: " << e.what());
         return false;
     }
     return true;
@@ -246,44 +500,184 @@ void create_table_verticalLineEquations(SQLite::Database& db)
         "indexNum INTEGER PRIMARY KEY, "
         "a REAL NOT NULL, "
         "b REAL NOT NULL)");
-    cout << "'verticalLineEquations' 테이블이 준비되었습니다.\n";
+    LOG_INFO("'verticalLineEquations' 테이블이 준비되었습니다.");
     return;
 }
 
-VerticalLineEquation select_data_verticalLineEquations(SQLite::Database& db, int index){
+VerticalLineEquation select_data_verticalLineEquations(DbHandle& db, int index){
     VerticalLineEquation verticalLineEquation;
     try {
-        SQLite::Statement query(db, "SELECT * FROM verticalLineEquations WHERE index = ?");
-        cout << "Prepared SQL for select data vector: " << query.getExpandedSQL() << endl;
-        query.exec();
+        auto query = db.prepare("SELECT * FROM verticalLineEquations WHERE index = ?");
+        LOG_DEBUG("Prepared SQL for select data vector: " << query->getExpandedSQL());
+        query->exec();
 
-        int indexNum = query.getColumn("indexNum").getInt();
-        double x = query.getColumn("x");
-        double y = query.getColumn("y");
+        int indexNum = query->getColumn("indexNum").getInt();
+        double x = query->getColumn("x");
+        double y = query->getColumn("y");
 
         verticalLineEquation = {indexNum, x, y};
 
     } catch (const exception& e) {
-        cerr << "사용자 조회 실패: " << e.what() << endl;
+        LOG_ERROR("사용자 조회 실패: " << e.what());
     }
     return verticalLineEquation;
 }
 
-bool insert_data_verticalLineEquations(SQLite::Database& db, int index, double a, double b){
+bool insert_data_verticalLineEquations(DbHandle& db, int index, double a, double b){
     try {
-        // SQL 인젝션 방지를 위해 Prepared Statement 사용
-        SQLite::Statement query(db, "INSERT INTO verticalLineEquations (indexNum, a, b) VALUES (?, ?, ?)");
-        query.bind(1, index);
-        query.bind(2, a);
-        query.bind(3, b);
-        cout << "Prepared SQL for insert: " << query.getExpandedSQL() << endl;
-        query.exec();
+        // SQL 인젝션 방지를 위해 Prepared Statement 사용 (연결별 캐시에서 재사용)
+        auto query = db.prepare("INSERT INTO verticalLineEquations (indexNum, a, b) VALUES (?, ?, ?)");
+        query->bind(1, index);
+        query->bind(2, a);
+        query->bind(3, b);
+        LOG_DEBUG("Prepared SQL for insert: " << query->getExpandedSQL());
+        query->exec();
         
-        cout << "데이터 추가: (인덱스: " << index << ")" << endl;
+        LOG_INFO("데이터 추가: (인덱스: " << index << ")");
     } catch (const exception& e) {
         // 이름이 중복될 경우 (UNIQUE 제약 조건 위반) 오류가 발생할 수 있습니다.
-        cerr << "데이터 '" << index << "' 추가 실패: " << e.what() << endl;
+        LOG_ERROR("데이터 '" << index << "' 추가 실패: " << e.what());
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////
+// 스키마 버전 관리
+
+// 컬럼이 없을 때만 추가 (메타데이터 프로세스가 먼저 컬럼을 만들었을 수 있음)
+static void add_column_if_missing(SQLite::Database& db, const string& table, const string& column, const string& type) {
+    SQLite::Statement query(db, "SELECT COUNT(*) FROM pragma_table_info(?) WHERE name = ?");
+    query.bind(1, table);
+    query.bind(2, column);
+    query.executeStep();
+    if (query.getColumn(0).getInt() == 0) {
+        db.exec("ALTER TABLE " + table + " ADD COLUMN " + column + " " + type);
+    }
+}
+
+// 새 테이블/인덱스/컬럼은 기존 항목을 고치지 말고 다음 버전 번호로 추가
+static const vector<SchemaMigration>& schema_migrations() {
+    static const vector<SchemaMigration> migrations = {
+        {1, "기본 테이블 생성", [](SQLite::Database& db) {
+            create_table_detections(db);
+            create_table_lines(db);
+            create_table_baseLines(db);
+            create_table_verticalLineEquations(db);
+        }},
+        {2, "detections.timestamp 인덱스 추가", [](SQLite::Database& db) {
+            db.exec("CREATE INDEX IF NOT EXISTS idx_detections_timestamp ON detections (timestamp)");
+        }},
+        {3, "detections.ts_ms (epoch 밀리초) 컬럼과 인덱스 추가", [](SQLite::Database& db) {
+            add_column_if_missing(db, "detections", "ts_ms", "INTEGER");
+            // 기존 행 변환: 'YYYY-MM-DDTHH:MM:SSKST' 는 KST, DEFAULT CURRENT_TIMESTAMP 로 들어간 값은 UTC
+            db.exec("UPDATE detections SET ts_ms = "
+                "CAST(strftime('%s', substr(timestamp, 1, 19)) AS INTEGER) * 1000 "
+                "- (CASE WHEN timestamp LIKE '%KST' THEN 32400000 ELSE 0 END) "
+                "WHERE ts_ms IS NULL");
+            db.exec("CREATE INDEX IF NOT EXISTS idx_detections_ts_ms ON detections (ts_ms)");
+            // 문자열 시각으로는 더 이상 조회하지 않음
+            db.exec("DROP INDEX IF EXISTS idx_detections_timestamp");
+        }},
+        {4, "detections 이미지 저장소 참조 컬럼(image_hash, image_size) 추가", [](SQLite::Database& db) {
+            // 기존 BLOB 은 서버 시작 시 migrate_images_to_store 가 옮김
+            add_column_if_missing(db, "detections", "image_hash", "TEXT");
+            add_column_if_missing(db, "detections", "image_size", "INTEGER");
+        }},
+        {5, "detections 썸네일 참조 컬럼(thumb_hash, thumb_size) 추가", [](SQLite::Database& db) {
+            // 기존 행의 썸네일은 서버 실행 중 백그라운드로 생성
+            add_column_if_missing(db, "detections", "thumb_hash", "TEXT");
+            add_column_if_missing(db, "detections", "thumb_size", "INTEGER");
+        }},
+        {6, "detections 이미지/썸네일 해시 인덱스 추가", [](SQLite::Database& db) {
+            // 보존 기간이 지난 행을 지울 때 파일을 다른 행이 아직 참조하는지 확인하는 데 사용
+            db.exec("CREATE INDEX IF NOT EXISTS idx_detections_image_hash ON detections (image_hash)");
+            db.exec("CREATE INDEX IF NOT EXISTS idx_detections_thumb_hash ON detections (thumb_hash)");
+        }},
+        {7, "설정 테이블(lines, baseLines) 변경 버전 추가", [](SQLite::Database& db) {
+            // 메타데이터 프로세스가 설정이 바뀌었을 때만 다시 읽도록, 두 테이블이 바뀔 때마다 트리거로 버전 증가
+            db.exec("CREATE TABLE IF NOT EXISTS config_version ("
+                "id INTEGER PRIMARY KEY CHECK (id = 1), "
+                "version INTEGER NOT NULL)");
+            db.exec("INSERT OR IGNORE INTO config_version (id, version) VALUES (1, 0)");
+            for (const string table : {"lines", "baseLines"}) {
+                for (const string event : {"INSERT", "UPDATE", "DELETE"}) {
+                    db.exec("CREATE TRIGGER IF NOT EXISTS trg_" + table + "_" + event + "_config_version "
+                        "AFTER " + event + " ON " + table + " "
+                        "BEGIN UPDATE config_version SET version = version + 1; END");
+                }
+            }
+        }},
+    };
+    return migrations;
+}
+
+int get_schema_version(SQLite::Database& db) {
+    db.exec("CREATE TABLE IF NOT EXISTS schema_version ("
+        "version INTEGER PRIMARY KEY, "
+        "description TEXT, "
+        "applied_at DATETIME DEFAULT CURRENT_TIMESTAMP NOT NULL)");
+    return db.execAndGet("SELECT IFNULL(MAX(version), 0) FROM schema_version").getInt();
+}
+
+bool migrate_schema(SQLite::Database& db) {
+    int current = 0;
+    try {
+        current = get_schema_version(db);
+    } catch (const exception& e) {
+        LOG_ERROR("스키마 버전 조회 실패: " << e.what());
+        return false;
+    }
+
+    for (const auto& migration : schema_migrations()) {
+        if (migration.version <= current) continue;
+        try {
+            SQLite::Transaction transaction(db);
+            migration.apply(db);
+            SQLite::Statement query(db, "INSERT INTO schema_version (version, description) VALUES (?, ?)");
+            query.bind(1, migration.version);
+            query.bind(2, migration.description);
+            query.exec();
+            transaction.commit();
+            current = migration.version;
+            LOG_INFO("스키마 버전 " << migration.version << " 적용: " << migration.description);
+        } catch (const exception& e) {
+            LOG_ERROR("스키마 버전 " << migration.version << " 적용 실패: " << e.what());
+            return false;
+        }
+    }
+
+    LOG_INFO("DB 스키마 버전: " << current);
+    return true;
+}
+
+bool enable_incremental_vacuum(SQLite::Database& db) {
+    try {
+        // 0 = NONE, 1 = FULL, 2 = INCREMENTAL
+        if (db.execAndGet("PRAGMA auto_vacuum").getInt() == 2) return true;
+
+        LOG_INFO("DB 파일을 auto_vacuum = INCREMENTAL 로 전환합니다. (VACUUM 한 번 실행)");
+        db.exec("PRAGMA auto_vacuum = INCREMENTAL");
+        db.exec("VACUUM");
+        if (db.execAndGet("PRAGMA auto_vacuum").getInt() != 2) {
+            LOG_ERROR("auto_vacuum 전환 실패");
+            return false;
+        }
+    } catch (const exception& e) {
+        LOG_ERROR("auto_vacuum 전환 실패: " << e.what());
+        return false;
+    }
+    return true;
+}
+
+int incremental_vacuum(SQLite::Database& db, int pages, int& remaining) {
+    int before = db.execAndGet("PRAGMA freelist_count").getInt();
+    if (before == 0) {
+        remaining = 0;
+        return 0;
+    }
+    // incremental_vacuum(0) 은 빈 페이지 전체를 반환하므로 1 이상으로 제한
+    db.exec("PRAGMA incremental_vacuum(" + to_string(max(pages, 1)) + ")");
+    remaining = db.execAndGet("PRAGMA freelist_count").getInt();
+    return before - remaining;
+}
@@ -3,24 +3,45 @@
 #pragma once
 // SQLiteC++ 외부 라이브러리
 #include <SQLiteCpp/SQLiteCpp.h>
+#include <SQLiteCpp/Blob.h>
 
 #include <iostream>   // 표준 입출력 (std::cout, std::cerr)
 #include <string>     // 문자열 처리 (std::string)
 #include <vector>     // 동적 배열 (std::vector, 여기서는 사용되지 않지만 이전 컨텍스트에서 포함됨)
 #include <fstream>    // 이미지 파일 테스트용
+#include <memory>
+#include <cstdint>
+#include <functional>
 
 // json 처리를 위한 외부 헤더파일
 #include "json.hpp"
 
+#include "statement_cache.hpp"
+#include "image_store.hpp"
+
 using namespace std;
 using json = nlohmann::json;
 
-// 감지 이미지 & 텍스트
-struct Detection{
-    vector<unsigned char> imageBlob;
+// 감지 시각 변환
+// detections.timestamp 는 표시용 문자열(예: 2025-08-01T12:00:00KST), 조회/정렬은 ts_ms (UTC 기준 epoch 밀리초) 로 함
+// "YYYY-MM-DD" 또는 "YYYY-MM-DD[T ]HH:MM:SS[.mmm]" 뒤에 KST / Z / ±HH:MM 이 붙을 수 있으며, 시간대가 없으면 KST 로 해석
+// 형식이 맞지 않으면 false
+bool parse_timestamp_ms(const string& timestamp, int64_t& epochMs);
+
+// 감지 결과의 이미지를 제외한 정보 (이미지는 DetectionImageReader 로 따로 읽음)
+struct DetectionRef{
+    int64_t id;
     string timestamp;
+    int imageSize;
+    int64_t tsMs = 0;
+    string imageHash;   // 이미지 저장소 해시 (비어 있으면 아직 detections.image BLOB 에 있는 이미지)
+    string thumbHash;   // 썸네일의 이미지 저장소 해시 (비어 있으면 아직 썸네일 없음)
+    int thumbSize = 0;
 };
 
+// 이미지 BLOB 을 나눠 읽는 단위 (3의 배수: 청크별 base64 인코딩 결과를 그대로 이어붙일 수 있음)
+const int DETECTION_IMAGE_CHUNK_SIZE = 48 * 1024;
+
 // 감지선
 struct CrossLine{
     int index;
@@ -55,30 +76,122 @@ struct VerticalLineEquation{
 
 void create_table_detections(SQLite::Database& db);
 
-bool insert_data_detections(SQLite::Database& db, vector<unsigned char> image, string timestamp);
+// 이미지를 읽지 않고 id, 시간, 이미지 크기만 조회
+vector<DetectionRef> select_refs_for_timestamp_range_detections(DbHandle& db, int64_t startMs, int64_t endMs);
+
+// 키셋 페이지 조회: (ts_ms, id) 가 (afterMs, afterId) 보다 크고 ts_ms <= endMs 인 행을 (ts_ms, id) 순으로 최대 limit 건
+vector<DetectionRef> select_refs_page_detections(DbHandle& db, int64_t afterMs, int64_t afterId, int64_t endMs, int limit);
+
+// id 로 한 건 조회 (없으면 false)
+bool select_ref_by_id_detections(DbHandle& db, int64_t id, DetectionRef& detection);
+
+// 썸네일이 없는 행을 id 순으로 afterId 다음부터 최대 limit 건 조회 (썸네일 백필용)
+vector<DetectionRef> select_refs_missing_thumbnail_detections(DbHandle& db, int64_t afterId, int limit);
+
+// 행의 썸네일 참조 기록
+bool update_thumbnail_detections(DbHandle& db, int64_t id, const string& thumbHash, int thumbSize);
+
+// detections 범위 조회 커서 (스트리밍 응답용)
+// (afterMs, afterId) 다음 행부터 ts_ms <= endMs 인 행을 최대 limit 건 한 행씩 읽으며, 이미지는 DetectionImageReader 로 따로 읽는다.
+// 조회 오류는 예외로 알림 (select_refs_page_detections 와 달리 빈 결과와 구분해야 하는 스트리밍에서 사용)
+class DetectionCursor {
+public:
+    DetectionCursor(DbHandle& db, int64_t afterMs, int64_t afterId, int64_t endMs, int limit);
+
+    // 다음 행을 detection 에 채움. 더 이상 행이 없으면 false
+    bool next(DetectionRef& detection);
+
+private:
+    CachedStatement query;      // 묶음마다 다시 만들어지므로 준비된 문장을 캐시에서 빌려 씀 (페이지 조회와 같은 문장)
+};
+
+// 감지 이미지 리더
+// 이미지 저장소에 있는 이미지는 파일을 mmap 해서 그대로 제공하고 (mapped_data),
+// 아직 detections.image BLOB 에 남아 있는 이미지는 incremental I/O 로 호출자 버퍼에 청크 단위로 읽어 넣는다.
+// 행이 바뀌면 BLOB 핸들을 새로 열지 않고 reopen 으로 재사용
+class DetectionImageReader {
+public:
+    DetectionImageReader(SQLite::Database& db, const ImageStore& store) : db(db), store(store) {}
+
+    // detection 의 이미지를 읽을 준비 (저장소 파일 크기가 DB 에 기록된 크기와 다르면 runtime_error)
+    void open(const DetectionRef& detection);
+    // 저장소 이미지면 mmap 된 이미지 전체, BLOB 이미지면 nullptr
+    const unsigned char* mapped_data() const { return mapped.data(); }
+    // 현재 이미지의 offset 부터 size 바이트를 buffer 에 읽음
+    void read(void* buffer, int size, int offset) const;
+
+private:
+    SQLite::Database& db;
+    const ImageStore& store;
+    unique_ptr<SQLite::Blob> blob;
+    MappedImage mapped;
+};
+
+// 모든 감지 결과와 그 이미지 파일 삭제
+void delete_all_data_detections(DbHandle& db, const ImageStore& store);
+
+// 보존 기간 관리 (하루 단위 파티션)
+// detections 는 ts_ms(UTC) 기준 하루를 한 파티션으로 보고, 보존 기간이 지난 파티션을 통째로 지움
+const int64_t DETECTION_PARTITION_MS = 24LL * 60 * 60 * 1000;
 
-vector<Detection> select_data_for_timestamp_range_detections(SQLite::Database& db, string startTimestamp, string endTimestamp);
+// 가장 오래된 감지 시각 (ts_ms 인덱스의 첫 항목, 행이 없으면 false)
+bool select_oldest_ts_ms_detections(DbHandle& db, int64_t& oldestMs);
 
-void delete_all_data_detections(SQLite::Database& db);
+// ts_ms 가 [fromMs, toMs) 인 행 삭제 후, 지운 행이 참조하던 이미지/썸네일 해시를 반환
+// 호출자가 트랜잭션 안에서 호출하고, 커밋한 뒤에 반환된 해시를 remove_unreferenced_images 로 정리할 것
+vector<string> delete_range_detections(DbHandle& db, int64_t fromMs, int64_t toMs, int& deletedRows);
+
+// hashes 중 어느 행도 참조하지 않는 이미지 파일을 삭제하고 지운 파일 수를 반환
+// 별도 트랜잭션(BEGIN IMMEDIATE)으로 쓰기 잠금을 잡고 참조를 다시 확인하므로, 다른 프로세스가 같은 이미지를 방금 기록한 경우 파일을 남김
+// (해시를 기록하는 쪽도 쓰기 잠금을 잡은 뒤 ImageStore::ensure 로 파일을 확인함)
+int remove_unreferenced_images(DbHandle& db, const ImageStore& store, const vector<string>& hashes);
+
+// detections.image BLOB 에 남아 있는 이미지를 이미지 저장소로 옮기고 BLOB 을 비움
+// batchSize 행씩 트랜잭션으로 처리하므로 중간에 멈춰도 다음 실행에서 이어서 처리됨, 옮긴 행 수를 반환
+int migrate_images_to_store(DbHandle& db, const ImageStore& store, int batchSize = 64);
 
 void create_table_lines(SQLite::Database& db);
 
-bool insert_data_lines(SQLite::Database& db, int indexNum ,int x1, int y1, int x2, int y2, string name, string mode, int leftMatrixNum, int rightMatrixNum);
+bool insert_data_lines(DbHandle& db, int indexNum ,int x1, int y1, int x2, int y2, string name, string mode, int leftMatrixNum, int rightMatrixNum);
 
-vector<CrossLine> select_all_data_lines(SQLite::Database& db);
+vector<CrossLine> select_all_data_lines(DbHandle& db);
 
-bool delete_data_lines(SQLite::Database& db, int indexNum);
+bool delete_data_lines(DbHandle& db, int indexNum);
 
-bool delete_all_data_lines(SQLite::Database& db);
+bool delete_all_data_lines(DbHandle& db);
 
 void create_table_baseLines(SQLite::Database& db);
 
-vector<BaseLine> select_all_data_baseLines(SQLite::Database& db);
+vector<BaseLine> select_all_data_baseLines(DbHandle& db);
 
-bool insert_data_baseLines(SQLite::Database& db,BaseLine baseline);
+bool insert_data_baseLines(DbHandle& db,BaseLine baseline);
 
 void create_table_verticalLineEquations(SQLite::Database& db);
 
-VerticalLineEquation select_data_verticalLineEquations(SQLite::Database& db, int index);
+VerticalLineEquation select_data_verticalLineEquations(DbHandle& db, int index);
+
+bool insert_data_verticalLineEquations(DbHandle& db, int index, double a, double b);
+
+///////////////////////////////////////////////
+// 스키마 버전 관리
+
+// 스키마 변경 한 단계 (version 순서대로 한 번씩만 적용)
+struct SchemaMigration {
+    int version;
+    string description;
+    function<void(SQLite::Database&)> apply;
+};
+
+// schema_version 테이블에 기록된 마지막 적용 버전 (아무것도 적용되지 않았으면 0)
+int get_schema_version(SQLite::Database& db);
+
+// 아직 적용되지 않은 마이그레이션을 버전 순서대로 각각 트랜잭션 안에서 적용
+// 서버 시작 시 한 번만 호출 (실패하면 false, 실패한 단계는 롤백됨)
+bool migrate_schema(SQLite::Database& db);
+
+// DB 파일을 auto_vacuum = INCREMENTAL 로 전환 (이미 전환되어 있으면 아무것도 하지 않음)
+// 기존 DB 는 전환에 VACUUM 이 필요하므로 파일 전체를 한 번 다시 씀, 서버 시작 시 요청을 받기 전에 호출 (실패하면 false)
+bool enable_incremental_vacuum(SQLite::Database& db);
 
-bool insert_data_verticalLineEquations(SQLite::Database& db, int index, double a, double b);
+// 빈 페이지를 최대 pages 개(1 이상) 파일 끝에서 잘라내고 반환한 페이지 수를 반환, remaining 에 남은 빈 페이지 수
+int incremental_vacuum(SQLite::Database& db, int pages, int& remaining);
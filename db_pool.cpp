@@ -0,0 +1,72 @@
+#include "db_pool.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+
+// 연결마다 적용하는 성능 관련 pragma
+static void configure_connection(SQLite::Database& db) {
+    db.setBusyTimeout(DB_BUSY_TIMEOUT_MS);
+    db.exec("PRAGMA synchronous = NORMAL");   // WAL 모드에서는 NORMAL 도 커밋된 데이터가 손상되지 않음 (전원 차단 시 마지막 커밋만 유실 가능)
+    db.exec("PRAGMA cache_size = -" + to_string(DB_CACHE_SIZE_KB));
+    db.exec("PRAGMA mmap_size = " + to_string(DB_MMAP_SIZE));
+    db.exec("PRAGMA temp_store = MEMORY");
+}
+
+DbConnection::DbConnection(DbConnection&& other) noexcept
+    : pool(other.pool), db(other.db), writer(other.writer) {
+    other.pool = nullptr;
+    other.db = nullptr;
+}
+
+DbConnection::~DbConnection() {
+    if (pool && db) pool->release(db, writer);
+}
+
+DbPool::DbPool(const string& path, size_t reader_count) {
+    // 연결 하나는 한 번에 한 스레드만 빌려 쓰므로 SQLite 내부 연결 뮤텍스는 생략 (OPEN_NOMUTEX)
+    writer = make_unique<DbHandle>(path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE | SQLite::OPEN_NOMUTEX);
+    configure_connection(*writer);
+    // journal_mode 는 DB 파일에 저장되므로 쓰기 연결에서 한 번만 설정하면 모든 연결(다른 프로세스 포함)에 적용됨
+    string journal_mode = writer->execAndGet("PRAGMA journal_mode = WAL").getString();
+    if (journal_mode != "wal") {
+        LOG_ERROR("WAL 모드 전환 실패 (현재 journal_mode: " << journal_mode << ")");
+    }
+
+    for (size_t i = 0; i < max<size_t>(reader_count, 1); i++) {
+        readers.push_back(make_unique<DbHandle>(path, SQLite::OPEN_READONLY | SQLite::OPEN_NOMUTEX));
+        configure_connection(*readers.back());
+        idle_readers.push_back(readers.back().get());
+    }
+    LOG_INFO("DB 연결 풀 준비: 읽기 " << readers.size() << "개, 쓰기 1개 (journal_mode: " << journal_mode << ")");
+}
+
+DbConnection DbPool::acquire_reader() {
+    unique_lock<mutex> lock(pool_mutex);
+    reader_cv.wait(lock, [this] { return !idle_readers.empty(); });
+    DbHandle* db = idle_readers.back();
+    idle_readers.pop_back();
+    return DbConnection(this, db, false);
+}
+
+DbConnection DbPool::acquire_writer() {
+    unique_lock<mutex> lock(pool_mutex);
+    writer_cv.wait(lock, [this] { return !writer_in_use; });
+    writer_in_use = true;
+    return DbConnection(this, writer.get(), true);
+}
+
+void DbPool::release(DbHandle* db, bool is_writer) {
+    {
+        lock_guard<mutex> lock(pool_mutex);
+        if (is_writer) {
+            writer_in_use = false;
+        } else {
+            idle_readers.push_back(db);
+        }
+    }
+    if (is_writer) {
+        writer_cv.notify_one();
+    } else {
+        reader_cv.notify_one();
+    }
+}
@@ -0,0 +1,183 @@
+#include "detection_writer.hpp"
+#include "db_management.hpp"
+#include "logger.hpp"
+
+#include <stdexcept>
+
+#include <sqlite3.h>
+
+// 서버가 쓰는 중이면 최대 5초 대기 (서버 연결 풀과 같은 값)
+static const int WRITER_BUSY_TIMEOUT_MS = 5000;
+
+// 잠금 대기 시간을 넘긴 트랜잭션(SQLITE_BUSY)을 다시 시도하는 횟수
+// (서버의 일회성 VACUUM 처럼 대기 시간보다 오래 잠금을 잡는 작업이 끝나기를 기다림)
+static const int WRITER_BUSY_RETRIES = 5;
+
+static bool is_busy(const exception& e) {
+    auto sqlite_error = dynamic_cast<const SQLite::Exception*>(&e);
+    return sqlite_error && (sqlite_error->getErrorCode() & 0xff) == SQLITE_BUSY;
+}
+
+DetectionWriter::DetectionWriter(const string& db_path, const ImageStore& store, const ThumbnailOptions& thumbnail_options,
+                                 size_t queue_size, size_t batch_size, chrono::milliseconds flush_interval)
+    : db(db_path, SQLite::OPEN_READWRITE),
+      store(store),
+      thumbnail_options(thumbnail_options),
+      queue_size(queue_size),
+      batch_size(batch_size),
+      flush_interval(flush_interval) {
+    db.setBusyTimeout(WRITER_BUSY_TIMEOUT_MS);
+    writer_thread = thread(&DetectionWriter::run, this);
+}
+
+DetectionWriter::~DetectionWriter() {
+    stop();
+}
+
+future<int64_t> DetectionWriter::submit(vector<unsigned char> image, string timestamp, int64_t ts_ms) {
+    PendingDetection pending{move(image), move(timestamp), ts_ms, promise<int64_t>()};
+    future<int64_t> row_id = pending.rowId.get_future();
+
+    unique_lock<mutex> lock(queue_mutex);
+    if (!stopping && queue.size() >= queue_size) {
+        LOG_WARN("Detection write queue is full, waiting for disk...");
+        queue_not_full.wait(lock, [this] { return stopping || queue.size() < queue_size; });
+    }
+    if (stopping) {
+        pending.rowId.set_exception(make_exception_ptr(runtime_error("DetectionWriter 가 종료됨")));
+        return row_id;
+    }
+    queue.push_back(move(pending));
+    lock.unlock();
+    queue_not_empty.notify_one();
+    return row_id;
+}
+
+void DetectionWriter::stop() {
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_not_empty.notify_all();
+    queue_not_full.notify_all();
+    if (writer_thread.joinable()) writer_thread.join();
+}
+
+void DetectionWriter::run() {
+    while (true) {
+        vector<PendingDetection> batch;
+        {
+            unique_lock<mutex> lock(queue_mutex);
+            queue_not_empty.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) break; // 종료 요청이고 남은 건이 없음
+
+            // 첫 건이 들어온 뒤 flush_interval 동안 묶음이 찰 때까지 기다림 (종료 중이면 바로 저장)
+            auto deadline = chrono::steady_clock::now() + flush_interval;
+            queue_not_empty.wait_until(lock, deadline, [this] { return stopping || queue.size() >= batch_size; });
+
+            size_t count = min(batch_size, queue.size());
+            batch.reserve(count);
+            for (size_t i = 0; i < count; i++) {
+                batch.push_back(move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        queue_not_full.notify_all();
+        write_batch(batch);
+    }
+
+    if (!unreferenced_hashes.empty()) remove_unreferenced();
+}
+
+void DetectionWriter::write_batch(vector<PendingDetection>& batch) {
+    // 1. 이미지/썸네일 파일 저장 (트랜잭션 밖, 실패한 건만 제외)
+    struct StoredDetection {
+        PendingDetection* pending;
+        string imageHash;
+        string thumbHash;
+        vector<unsigned char> thumbnail;    // 트랜잭션 안에서 파일이 지워졌으면 다시 쓰기 위해 보관
+    };
+    vector<StoredDetection> stored;
+    stored.reserve(batch.size());
+    for (auto& pending : batch) {
+        try {
+            StoredDetection detection{&pending, store.put(pending.image), string(), vector<unsigned char>()};
+            if (make_thumbnail(pending.image.data(), pending.image.size(), thumbnail_options, detection.thumbnail)) {
+                detection.thumbHash = store.put(detection.thumbnail);
+            }
+            stored.push_back(move(detection));
+        } catch (const exception& e) {
+            LOG_ERROR("Failed to store detection image (" << pending.timestamp << "): " << e.what());
+            pending.rowId.set_exception(current_exception());
+        }
+    }
+    if (stored.empty()) return;
+
+    // 2. 묶음 전체를 한 트랜잭션으로 INSERT (커밋 한 번 = fsync 한 번, 잠금을 얻지 못하면 묶음째 다시 시도)
+    vector<int64_t> row_ids;
+    row_ids.reserve(stored.size());
+    for (int attempt = 1;; attempt++) {
+        try {
+            // 쓰기 잠금을 먼저 잡고 파일이 남아 있는지 확인 (서버의 보존 기간 정리가 같은 이미지를 방금 지웠으면 다시 씀)
+            SQLite::Transaction transaction(db, SQLite::TransactionBehavior::IMMEDIATE);
+            for (const auto& detection : stored) {
+                store.ensure(detection.imageHash, detection.pending->image);
+                if (!detection.thumbHash.empty()) store.ensure(detection.thumbHash, detection.thumbnail);
+
+                auto query = db.prepare("INSERT INTO detections (image_hash, image_size, thumb_hash, thumb_size, timestamp, ts_ms) VALUES (?, ?, ?, ?, ?, ?)");
+                query->bind(1, detection.imageHash);
+                query->bind(2, static_cast<int64_t>(detection.pending->image.size()));
+                if (!detection.thumbHash.empty()) {
+                    query->bind(3, detection.thumbHash);
+                    query->bind(4, static_cast<int64_t>(detection.thumbnail.size()));
+                }
+                query->bind(5, detection.pending->timestamp);
+                query->bind(6, detection.pending->tsMs);
+                query->exec();
+                row_ids.push_back(db.getLastInsertRowid());
+            }
+            transaction.commit();
+            break;
+        } catch (const exception& e) {
+            row_ids.clear();
+            if (is_busy(e) && attempt <= WRITER_BUSY_RETRIES) {
+                LOG_WARN("DB is busy, retrying " << stored.size() << " detections (" << attempt << "/" << WRITER_BUSY_RETRIES << ")");
+                continue;
+            }
+
+            // 롤백되었으므로 묶음 전체 실패
+            LOG_ERROR("Failed to insert " << stored.size() << " detections into DB: " << e.what());
+            for (auto& detection : stored) {
+                detection.pending->rowId.set_exception(current_exception());
+            }
+
+
+            // 1 에서 저장한 파일 중 다른 행이 참조하지 않는 것은 지움 (남겨 두면 어느 행도 가리키지 않는 파일이 됨)
+            for (const auto& detection : stored) {
+                unreferenced_hashes.push_back(detection.imageHash);
+                if (!detection.thumbHash.empty()) unreferenced_hashes.push_back(detection.thumbHash);
+            }
+            remove_unreferenced();
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < stored.size(); i++) {
+        stored[i].pending->rowId.set_value(row_ids[i]);
+    }
+    LOG_INFO(stored.size() << " detection(s) inserted to DB in one transaction (last: " << stored.back().pending->timestamp << ")");
+
+    // 앞서 실패한 묶음의 파일을 그때 지우지 못했으면 잠금을 얻을 수 있는 지금 다시 시도
+    if (!unreferenced_hashes.empty()) remove_unreferenced();
+}
+
+void DetectionWriter::remove_unreferenced() {
+    try {
+        int removed = remove_unreferenced_images(db, store, unreferenced_hashes);
+        LOG_INFO("Removed " << removed << " image file(s) left by a failed detection batch");
+        unreferenced_hashes.clear();
+    } catch (const exception& e) {
+        // 다음 묶음을 커밋한 뒤나 종료할 때 다시 시도
+        LOG_WARN("Failed to remove image files of a failed detection batch, will retry: " << e.what());
+    }
+}
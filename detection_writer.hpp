@@ -0,0 +1,78 @@
+// 감지 결과 비동기 저장 모듈 (write-behind)
+// 호출 스레드는 감지 이미지를 대기열에 넣고 바로 돌아가며, 전용 쓰기 스레드가 이미지/썸네일 파일을 저장하고
+// 모인 INSERT 를 한 트랜잭션으로 묶어 커밋한다. (그룹 커밋: 경고가 몰려도 fsync 는 묶음마다 한 번)
+// 호출자는 future 로 삽입된 행 id 를 받을 수 있다.
+// 쓰기 잠금을 얻지 못한 묶음(SQLITE_BUSY)은 다시 시도하고, 끝내 실패하면 그 묶음이 저장한 파일 중 참조되지 않는 것을 지운다.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+#include "statement_cache.hpp"
+#include "image_store.hpp"
+#include "thumbnail.hpp"
+
+using namespace std;
+
+// 대기열/묶음 설정 기본값
+const size_t DETECTION_WRITER_QUEUE_SIZE = 64;                          // 대기열 최대 길이 (가득 차면 submit 이 대기)
+const size_t DETECTION_WRITER_BATCH_SIZE = 16;                          // 한 트랜잭션에 묶는 최대 건수
+const chrono::milliseconds DETECTION_WRITER_FLUSH_INTERVAL(200);        // 첫 건이 들어온 뒤 묶음을 기다리는 최대 시간
+
+class DetectionWriter {
+public:
+    // db_path 에 쓰기 전용 연결을 따로 열고 쓰기 스레드 시작 (열기에 실패하면 SQLite::Exception)
+    DetectionWriter(const string& db_path, const ImageStore& store, const ThumbnailOptions& thumbnail_options,
+                    size_t queue_size = DETECTION_WRITER_QUEUE_SIZE, size_t batch_size = DETECTION_WRITER_BATCH_SIZE,
+                    chrono::milliseconds flush_interval = DETECTION_WRITER_FLUSH_INTERVAL);
+    // 대기열에 남은 건을 모두 저장한 뒤 종료
+    ~DetectionWriter();
+
+    DetectionWriter(const DetectionWriter&) = delete;
+    DetectionWriter& operator=(const DetectionWriter&) = delete;
+
+    // 감지 이미지 저장 요청 (timestamp: 표시용 문자열, ts_ms: 조회용 UTC epoch 밀리초)
+    // 저장되면 future 에 detections.id, 실패하면 예외가 담김. 대기열이 가득 차 있으면 자리가 날 때까지 대기
+    future<int64_t> submit(vector<unsigned char> image, string timestamp, int64_t ts_ms);
+
+    // 새 요청을 받지 않고 남은 건을 저장한 뒤 쓰기 스레드 종료 (여러 번 호출해도 됨)
+    void stop();
+
+private:
+    struct PendingDetection {
+        vector<unsigned char> image;
+        string timestamp;
+        int64_t tsMs;
+        promise<int64_t> rowId;
+    };
+
+    void run();
+    void write_batch(vector<PendingDetection>& batch);
+    // unreferenced_hashes 중 어느 행도 참조하지 않는 파일을 지움 (실패하면 남겨 두고 나중에 다시 시도)
+    void remove_unreferenced();
+
+    DbHandle db;
+    const ImageStore& store;
+    const ThumbnailOptions thumbnail_options;
+    const size_t queue_size;
+    const size_t batch_size;
+    const chrono::milliseconds flush_interval;
+
+    mutex queue_mutex;
+    condition_variable queue_not_empty;
+    condition_variable queue_not_full;
+    deque<PendingDetection> queue;
+    bool stopping = false;
+
+    // 커밋에 실패한 묶음이 저장해 둔 파일의 해시 (쓰기 스레드 전용)
+    vector<string> unreferenced_hashes;
+    thread writer_thread;
+};
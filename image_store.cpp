@@ -0,0 +1,177 @@
+#include "image_store.hpp"
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <openssl/evp.h>
+
+// 오류 메시지에 errno 설명을 붙임
+static runtime_error io_error(const string& what, const string& path) {
+    return runtime_error(what + " (" + path + "): " + strerror(errno));
+}
+
+static string sha256_hex(const unsigned char* data, size_t size) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    if (EVP_Digest(data, size, digest, &digest_len, EVP_sha256(), nullptr) != 1) {
+        throw runtime_error("SHA-256 계산 실패");
+    }
+
+    static const char HEX[] = "0123456789abcdef";
+    string hex;
+    hex.reserve(digest_len * 2);
+    for (unsigned int i = 0; i < digest_len; i++) {
+        hex.push_back(HEX[digest[i] >> 4]);
+        hex.push_back(HEX[digest[i] & 0x0f]);
+    }
+    return hex;
+}
+
+static void make_directory(const string& path) {
+    if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw io_error("디렉터리 생성 실패", path);
+    }
+}
+
+/*
+
+MappedImage
+
+*/
+
+MappedImage::MappedImage(MappedImage&& other) noexcept : addr(other.addr), length(other.length) {
+    other.addr = nullptr;
+    other.length = 0;
+}
+
+MappedImage& MappedImage::operator=(MappedImage&& other) noexcept {
+    if (this != &other) {
+        if (addr) munmap(addr, length);
+        addr = other.addr;
+        length = other.length;
+        other.addr = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+MappedImage::~MappedImage() {
+    if (addr) munmap(addr, length);
+}
+
+/*
+
+ImageStore
+
+*/
+
+ImageStore::ImageStore(const string& root) : root(root) {
+    make_directory(root);
+}
+
+bool ImageStore::valid_hash(const string& hash) {
+    if (hash.size() != 64) return false;
+    for (char c : hash) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+    }
+    return true;
+}
+
+string ImageStore::path_for(const string& hash) const {
+    return root + "/" + hash.substr(0, 2) + "/" + hash + ".jpg";
+}
+
+string ImageStore::put(const unsigned char* data, size_t size) const {
+    string hash = sha256_hex(data, size);
+
+    // 같은 내용이 이미 저장되어 있음
+    if (access(path_for(hash).c_str(), F_OK) == 0) return hash;
+
+    write_file(hash, data, size);
+    return hash;
+}
+
+void ImageStore::ensure(const string& hash, const unsigned char* data, size_t size) const {
+    if (access(path_for(hash).c_str(), F_OK) == 0) return;
+    write_file(hash, data, size);
+}
+
+void ImageStore::write_file(const string& hash, const unsigned char* data, size_t size) const {
+    string path = path_for(hash);
+    string dir = root + "/" + hash.substr(0, 2);
+    make_directory(dir);
+
+    string tmp_path = dir + "/.tmp-XXXXXX";
+    int fd = mkstemp(&tmp_path[0]);
+    if (fd < 0) throw io_error("임시 파일 생성 실패", tmp_path);
+
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = write(fd, data + written, size - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            runtime_error error = io_error("이미지 쓰기 실패", tmp_path);
+            close(fd);
+            unlink(tmp_path.c_str());
+            throw error;
+        }
+        written += n;
+    }
+
+    // DB 에 해시를 기록하기 전에 파일 내용이 디스크에 있도록 함
+    if (fsync(fd) != 0 || fchmod(fd, 0644) != 0) {
+        runtime_error error = io_error("이미지 fsync 실패", tmp_path);
+        close(fd);
+        unlink(tmp_path.c_str());
+        throw error;
+    }
+    close(fd);
+
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        runtime_error error = io_error("이미지 파일 이름 변경 실패", path);
+        unlink(tmp_path.c_str());
+        throw error;
+    }
+}
+
+MappedImage ImageStore::open(const string& hash) const {
+    if (!valid_hash(hash)) throw runtime_error("잘못된 이미지 해시: " + hash);
+
+    string path = path_for(hash);
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw io_error("이미지 파일 열기 실패", path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        runtime_error error = io_error("이미지 파일 정보 조회 실패", path);
+        close(fd);
+        throw error;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return MappedImage();
+    }
+
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        runtime_error error = io_error("이미지 파일 mmap 실패", path);
+        close(fd);
+        throw error;
+    }
+    close(fd); // 매핑은 fd 를 닫아도 유지됨
+
+    // 곧 전부 순서대로 읽어 송신 버퍼로 복사함
+    madvise(addr, st.st_size, MADV_WILLNEED);
+    return MappedImage(addr, st.st_size);
+}
+
+bool ImageStore::remove(const string& hash) const {
+    if (!valid_hash(hash)) return false;
+    return unlink(path_for(hash).c_str()) == 0;
+}
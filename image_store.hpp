@@ -0,0 +1,67 @@
+// 감지 이미지 저장소 모듈
+// 이미지를 DB BLOB 대신 내용의 SHA-256 해시를 이름으로 하는 파일로 저장한다. (같은 이미지는 한 번만 저장)
+// DB(detections)에는 해시와 크기만 기록하고, 읽을 때는 파일을 mmap 해서 송신 버퍼로 바로 복사한다.
+//
+// 디렉터리 구조 : <root>/<해시 앞 2자리>/<해시 64자리>.jpg
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+// mmap 으로 연 이미지 파일 (읽기 전용, 소멸 시 munmap)
+class MappedImage {
+public:
+    MappedImage() = default;
+    MappedImage(void* addr, size_t length) : addr(addr), length(length) {}
+    MappedImage(MappedImage&& other) noexcept;
+    MappedImage& operator=(MappedImage&& other) noexcept;
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+    ~MappedImage();
+
+    const unsigned char* data() const { return static_cast<const unsigned char*>(addr); }
+    size_t size() const { return length; }
+
+private:
+    void* addr = nullptr;
+    size_t length = 0;
+};
+
+class ImageStore {
+public:
+    // root 디렉터리를 저장소로 사용 (없으면 생성, 실패하면 runtime_error)
+    explicit ImageStore(const string& root);
+
+    // 이미지를 저장하고 SHA-256 해시(소문자 hex 64자)를 반환 (같은 내용의 파일이 이미 있으면 다시 쓰지 않음)
+    // 임시 파일에 쓰고 fsync 후 rename 하므로 중간에 전원이 꺼져도 반쯤 쓰인 파일이 해시 이름으로 남지 않음
+    // 실패하면 runtime_error
+    string put(const unsigned char* data, size_t size) const;
+    string put(const vector<unsigned char>& image) const { return put(image.data(), image.size()); }
+
+    // put 으로 받은 해시의 파일이 그사이 지워졌으면 같은 내용으로 다시 씀 (실패하면 runtime_error)
+    // 보존 기간 정리는 DB 쓰기 잠금을 잡고 참조를 확인한 뒤 파일을 지우므로, 해시를 기록하는 쪽은
+    // 쓰기 잠금을 잡은 트랜잭션(BEGIN IMMEDIATE) 안에서 이 함수를 불러 행과 파일이 어긋나지 않게 함
+    void ensure(const string& hash, const unsigned char* data, size_t size) const;
+    void ensure(const string& hash, const vector<unsigned char>& image) const { ensure(hash, image.data(), image.size()); }
+
+    // 해시의 이미지를 mmap 으로 엶 (없거나 열 수 없으면 runtime_error)
+    MappedImage open(const string& hash) const;
+
+    // 해시의 이미지 파일 삭제 (DB 쓰기 잠금을 잡은 상태에서 이 해시를 참조하는 행이 없음을 확인한 뒤 호출할 것)
+    bool remove(const string& hash) const;
+
+    string path_for(const string& hash) const;
+
+    // SHA-256 hex 형식인지 확인 (경로 조작 방지)
+    static bool valid_hash(const string& hash);
+
+private:
+    // 임시 파일에 쓰고 fsync 후 해시 이름으로 rename
+    void write_file(const string& hash, const unsigned char* data, size_t size) const;
+
+    string root;
+};
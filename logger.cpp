@@ -0,0 +1,155 @@
+#include "logger.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <strings.h>
+
+// 버퍼가 비어 있을 때 출력 스레드가 쉬는 시간 (로그가 화면에 늦게 보이는 최대 시간)
+static const chrono::milliseconds LOG_DRAIN_INTERVAL(10);
+
+static const int64_t LOG_KST_OFFSET_SECONDS = 9 * 60 * 60;
+
+static const char* level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARN: return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "";
+    }
+}
+
+static int64_t now_ms() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+LogLevel parse_log_level(const char* value, LogLevel fallback) {
+    if (value == nullptr) return fallback;
+    if (strcasecmp(value, "debug") == 0) return LogLevel::DEBUG;
+    if (strcasecmp(value, "info") == 0) return LogLevel::INFO;
+    if (strcasecmp(value, "warn") == 0 || strcasecmp(value, "warning") == 0) return LogLevel::WARN;
+    if (strcasecmp(value, "error") == 0) return LogLevel::ERROR;
+    if (strcasecmp(value, "off") == 0) return LogLevel::OFF;
+    fprintf(stderr, "LOG_LEVEL 값 '%s' 을 알 수 없어 기본값 %s 사용\n", value, level_name(fallback));
+    return fallback;
+}
+
+Logger& Logger::instance() {
+    static Logger logger(LOG_BUFFER_CAPACITY);
+    return logger;
+}
+
+Logger::Logger(size_t capacity)
+    : capacity(capacity),
+      slots(new Slot[capacity]),
+      runtime_level(static_cast<int>(parse_log_level(getenv("LOG_LEVEL"), LogLevel::INFO))) {
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i].sequence.store(i, memory_order_relaxed);
+    }
+    drain_thread = thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    stopping.store(true, memory_order_release);
+    if (drain_thread.joinable()) drain_thread.join();
+}
+
+void Logger::write(LogLevel level, string message) {
+    int64_t time_ms = now_ms();
+
+    // 출력 스레드가 끝난 뒤 (프로세스 종료 중) 에는 바로 출력
+    if (stopped.load(memory_order_acquire)) {
+        fprintf(level >= LogLevel::WARN ? stderr : stdout, "[%s] %s\n", level_name(level), message.c_str());
+        return;
+    }
+
+    // 빈 칸 하나를 CAS 로 차지 (다중 생산자, 단일 소비자 링 버퍼)
+    size_t pos = enqueue_pos.load(memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[pos & (capacity - 1)];
+        size_t sequence = slot->sequence.load(memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // 한 바퀴 전 로그가 아직 출력되지 않음 = 가득 참
+            dropped.fetch_add(1, memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueue_pos.load(memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->time_ms = time_ms;
+    slot->message = move(message);
+    slot->sequence.store(pos + 1, memory_order_release);
+}
+
+void Logger::flush() {
+    size_t target = enqueue_pos.load(memory_order_acquire);
+    while (!stopped.load(memory_order_acquire) && dequeue_pos.load(memory_order_acquire) < target) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
+
+void Logger::run() {
+    while (true) {
+        size_t count = drain();
+        if (count == 0) {
+            if (stopping.load(memory_order_acquire)) break;
+            this_thread::sleep_for(LOG_DRAIN_INTERVAL);
+        }
+    }
+    stopped.store(true, memory_order_release);
+}
+
+size_t Logger::drain() {
+    size_t count = 0;
+    size_t pos = dequeue_pos.load(memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots[pos & (capacity - 1)];
+        if (slot.sequence.load(memory_order_acquire) != pos + 1) break;
+
+        print(slot.level, slot.time_ms, slot.message);
+        slot.message.clear();
+        // 다음 바퀴의 같은 위치를 쓸 수 있게 표시
+        slot.sequence.store(pos + capacity, memory_order_release);
+        pos++;
+        count++;
+        dequeue_pos.store(pos, memory_order_release);
+    }
+
+    uint64_t lost = dropped.exchange(0, memory_order_relaxed);
+    if (lost > 0) {
+        print(LogLevel::WARN, now_ms(), "로그 버퍼가 가득 차 " + to_string(lost) + "건을 버렸습니다.");
+    }
+    if (count > 0 || lost > 0) {
+        fflush(stdout);
+        fflush(stderr);
+    }
+    return count;
+}
+
+void Logger::print(LogLevel level, int64_t time_ms, const string& message) {
+    // 한국 시간 (KST), 초가 바뀔 때만 날짜 문자열을 다시 만듦
+    int64_t second = time_ms / 1000;
+    if (second != formatted_second) {
+        time_t kst = static_cast<time_t>(second + LOG_KST_OFFSET_SECONDS);
+        tm kst_tm;
+        gmtime_r(&kst, &kst_tm);
+        strftime(time_prefix, sizeof(time_prefix), "%Y-%m-%d %H:%M:%S", &kst_tm);
+        formatted_second = second;
+    }
+
+    FILE* stream = level >= LogLevel::WARN ? stderr : stdout;
+    // stdout 은 버퍼링되므로 stderr 로 바꾸기 전에 비워 순서를 유지
+    if (last_stream == stdout && stream != stdout) fflush(stdout);
+    last_stream = stream;
+
+    fprintf(stream, "[%s.%03d KST] [%s] ", time_prefix, static_cast<int>(time_ms % 1000), level_name(level));
+    fwrite(message.data(), 1, message.size(), stream);
+    fputc('\n', stream);
+}
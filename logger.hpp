@@ -0,0 +1,108 @@
+// 비동기 로그 모듈
+// 로그를 남기는 스레드는 레벨만 확인하고 메시지를 만들어 고정 크기 링 버퍼에 넣은 뒤 바로 돌아간다.
+// 시각 붙이기와 stdout/stderr 쓰기는 백그라운드 스레드가 모아서 처리하므로 요청/프레임 처리 중에 flush 를 기다리지 않는다.
+//
+// 레벨은 두 번 거른다.
+//  - 컴파일 시: LOG_COMPILE_LEVEL 보다 낮은 LOG_* 는 코드에서 빠짐 (예: -DLOG_COMPILE_LEVEL=1 이면 LOG_DEBUG 제거)
+//  - 실행 시: 환경변수 LOG_LEVEL (debug, info, warn, error, off), 기본 info
+// LOG_* 의 인자는 레벨이 꺼져 있으면 평가되지 않으므로 getExpandedSQL(), dump() 같은 비싼 식을 그대로 넣어도 된다.
+//
+// 사용 예: LOG_INFO("데이터 추가: (시간: " << timestamp << ")");
+// INFO 이하는 stdout, WARN 이상은 stderr 로 출력한다.
+// 버퍼가 가득 차면 새 로그는 버리고 버린 건수를 나중에 WARN 으로 남긴다. (로그 때문에 처리 스레드가 멈추지 않도록)
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <cstdio>
+
+using namespace std;
+
+enum class LogLevel : int {
+    DEBUG = 0,
+    INFO = 1,
+    WARN = 2,
+    ERROR = 3,
+    OFF = 4,
+};
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0
+#endif
+
+const size_t LOG_BUFFER_CAPACITY = 4096;   // 링 버퍼 칸 수 (2의 거듭제곱)
+
+class Logger {
+public:
+    // 프로세스 전체에서 공유하는 로거 (처음 호출할 때 출력 스레드 시작)
+    static Logger& instance();
+
+    bool enabled(LogLevel level) const {
+        return static_cast<int>(level) >= runtime_level.load(memory_order_relaxed);
+    }
+    void set_level(LogLevel level) { runtime_level.store(static_cast<int>(level), memory_order_relaxed); }
+
+    // 링 버퍼에 넣기만 함 (여러 스레드에서 잠금 없이 호출 가능)
+    void write(LogLevel level, string message);
+
+    // 지금까지 넣은 로그가 모두 출력될 때까지 대기
+    void flush();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+private:
+    explicit Logger(size_t capacity);
+    ~Logger();
+
+    // 칸마다 sequence 로 상태를 표시 (== 위치: 비어 있음, == 위치 + 1: 채워짐)
+    struct Slot {
+        atomic<size_t> sequence;
+        LogLevel level;
+        int64_t time_ms;
+        string message;
+    };
+
+    void run();
+    // 채워진 칸을 모두 꺼내 출력, 꺼낸 건수를 반환 (출력 스레드 전용)
+    size_t drain();
+    void print(LogLevel level, int64_t time_ms, const string& message);
+
+    const size_t capacity;
+    unique_ptr<Slot[]> slots;
+    alignas(64) atomic<size_t> enqueue_pos{0};
+    alignas(64) atomic<size_t> dequeue_pos{0};   // 출력 스레드만 증가시킴
+    atomic<uint64_t> dropped{0};
+    atomic<int> runtime_level;
+    atomic<bool> stopping{false};
+    atomic<bool> stopped{false};
+
+    // 출력 스레드 전용 상태 (초 단위 시각 문자열 재사용, 마지막으로 쓴 스트림)
+    int64_t formatted_second = -1;
+    char time_prefix[32] = {};
+    FILE* last_stream = nullptr;
+
+    thread drain_thread;
+};
+
+// 환경변수 LOG_LEVEL 값을 레벨로 변환 (알 수 없는 값이면 fallback)
+LogLevel parse_log_level(const char* value, LogLevel fallback);
+
+#define LOG_AT(level, expr)                                                                   \
+    do {                                                                                      \
+        if (static_cast<int>(level) >= LOG_COMPILE_LEVEL && Logger::instance().enabled(level)) { \
+            ostringstream log_stream_;                                                        \
+            log_stream_ << expr;                                                              \
+            Logger::instance().write(level, log_stream_.str());                               \
+        }                                                                                     \
+    } while (0)
+
+#define LOG_DEBUG(expr) LOG_AT(LogLevel::DEBUG, expr)
+#define LOG_INFO(expr) LOG_AT(LogLevel::INFO, expr)
+#define LOG_WARN(expr) LOG_AT(LogLevel::WARN, expr)
+#define LOG_ERROR(expr) LOG_AT(LogLevel::ERROR, expr)
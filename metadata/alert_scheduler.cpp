@@ -0,0 +1,115 @@
+#include "alert_scheduler.hpp"
+#include "board_control.h"
+#include "../logger.hpp"
+
+#include <algorithm>
+
+AlertScheduler::AlertScheduler(Actuator actuator, chrono::milliseconds tick, size_t wheel_size)
+    : actuator(move(actuator)),
+      tick(max(tick, chrono::milliseconds(1))),
+      start_time(chrono::steady_clock::now()),
+      wheel(max<size_t>(wheel_size, 1)) {
+    scheduler_thread = thread(&AlertScheduler::run, this);
+}
+
+AlertScheduler::~AlertScheduler() {
+    stop();
+}
+
+uint64_t AlertScheduler::tick_at(chrono::steady_clock::time_point time) const {
+    return static_cast<uint64_t>((time - start_time) / tick);
+}
+
+void AlertScheduler::trigger(int board_id, chrono::milliseconds hold) {
+    // 끝 틱을 올림해서 hold 보다 일찍 꺼지지 않게 함
+    auto off_time = chrono::steady_clock::now() + hold;
+    uint64_t off_tick = tick_at(off_time) + 1;
+
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        if (stopping) return;
+
+        auto it = off_ticks.find(board_id);
+        if (it != off_ticks.end()) {
+            // 이미 켜져 있음: 휠 항목은 그대로 두고 끄는 틱만 늘림 (만료 시 다시 확인해서 옮김)
+            it->second = max(it->second, off_tick);
+            LOG_DEBUG("Board " << board_id << " alert extended to tick " << it->second);
+            return;
+        }
+        // 켜진 보드가 없어 쉬는 동안 지난 틱은 휠이 비어 있으므로 돌지 않고 건너뜀
+        if (off_ticks.empty()) {
+            current_tick = max(current_tick, tick_at(off_time - hold));
+        }
+        off_ticks.emplace(board_id, off_tick);
+        wheel[off_tick % wheel.size()].push_back(board_id);
+        commands.emplace_back(board_id, CMD_LCD_ON);
+    }
+    wakeup.notify_one();
+}
+
+void AlertScheduler::stop() {
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    if (scheduler_thread.joinable()) scheduler_thread.join();
+}
+
+void AlertScheduler::advance_to(uint64_t tick) {
+    vector<int> expired;
+    while (current_tick < tick) {
+        current_tick++;
+        auto& slot = wheel[current_tick % wheel.size()];
+        if (slot.empty()) continue;
+
+        expired.swap(slot);
+        for (int board_id : expired) {
+            auto it = off_ticks.find(board_id);
+            if (it == off_ticks.end()) continue;
+            if (it->second <= current_tick) {
+                off_ticks.erase(it);
+                commands.emplace_back(board_id, CMD_LCD_OFF);
+            } else {
+                // 연장됐거나 아직 한 바퀴 이상 남음: 끌 틱의 슬롯으로 옮김
+                wheel[it->second % wheel.size()].push_back(board_id);
+            }
+        }
+        expired.clear();
+    }
+}
+
+void AlertScheduler::run() {
+    unique_lock<mutex> lock(queue_mutex);
+    while (true) {
+        advance_to(tick_at(chrono::steady_clock::now()));
+
+        if (stopping) {
+            // 켜 둔 채로 끝내지 않도록 남은 보드를 모두 끔
+            for (const auto& [board_id, off_tick] : off_ticks) {
+                commands.emplace_back(board_id, CMD_LCD_OFF);
+            }
+            off_ticks.clear();
+            for (auto& slot : wheel) slot.clear();
+        }
+
+        // 명령은 잠금 밖에서 보냄 (송신/ACK 대기 중에도 trigger 는 바로 반환)
+        while (!commands.empty()) {
+            auto [board_id, cmd] = commands.front();
+            commands.pop_front();
+            lock.unlock();
+            actuator(board_id, cmd);
+            lock.lock();
+            advance_to(tick_at(chrono::steady_clock::now()));
+        }
+
+        if (stopping) return;
+
+        // 켜진 보드가 없으면 다음 경고까지, 있으면 다음 틱까지 대기
+        if (off_ticks.empty()) {
+            wakeup.wait(lock, [this] { return stopping || !commands.empty(); });
+        } else {
+            wakeup.wait_until(lock, start_time + tick * (current_tick + 1), [this] { return stopping || !commands.empty(); });
+        }
+    }
+}
@@ -0,0 +1,61 @@
+// 보드 경고(LCD) 스케줄러
+// 경고가 나면 LCD-on 을 바로 보내고, LCD-off 는 해시 타이머 휠에 타이머로 건다.
+// 켜져 있는 보드에 경고가 다시 나면 타이머를 새로 쌓지 않고 끄는 시각만 뒤로 미룸 (보드마다 휠 항목은 하나)
+// 보드 명령은 전용 스레드가 보내므로 trigger 를 호출한 메타데이터 처리 스레드는 UART 송신/ACK 대기를 기다리지 않는다.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+
+// 타이머 휠 설정 기본값 (64 슬롯 x 100ms = 6.4초, 기본 경고 유지 시간이 한 바퀴 안에 들어감)
+const chrono::milliseconds ALERT_SCHEDULER_TICK(100);
+const size_t ALERT_SCHEDULER_WHEEL_SIZE = 64;
+
+class AlertScheduler {
+public:
+    // 보드에 명령 하나를 보내는 함수 (스케줄러 스레드에서 호출)
+    using Actuator = function<void(int board_id, uint8_t cmd)>;
+
+    AlertScheduler(Actuator actuator, chrono::milliseconds tick = ALERT_SCHEDULER_TICK, size_t wheel_size = ALERT_SCHEDULER_WHEEL_SIZE);
+    // 켜져 있는 보드를 모두 끈 뒤 종료
+    ~AlertScheduler();
+
+    AlertScheduler(const AlertScheduler&) = delete;
+    AlertScheduler& operator=(const AlertScheduler&) = delete;
+
+    // 보드 LCD 를 켜고 hold 뒤에 끔 (이미 켜져 있으면 끄는 시각만 now + hold 까지 연장), 바로 반환
+    void trigger(int board_id, chrono::milliseconds hold);
+
+    // 새 경고를 받지 않고, 켜져 있는 보드에 LCD-off 를 보낸 뒤 스레드 종료 (여러 번 호출해도 됨)
+    void stop();
+
+private:
+    void run();
+    uint64_t tick_at(chrono::steady_clock::time_point time) const;
+    // 현재 틱까지 지난 슬롯을 돌며 만료된 보드의 LCD-off 를 commands 에 넣음 (queue_mutex 보유 상태)
+    void advance_to(uint64_t tick);
+
+    const Actuator actuator;
+    const chrono::milliseconds tick;
+    const chrono::steady_clock::time_point start_time;
+
+    mutex queue_mutex;
+    condition_variable wakeup;
+    vector<vector<int>> wheel;                  // 슬롯(끌 틱 % 휠 크기)별 보드 id
+    unordered_map<int, uint64_t> off_ticks;     // 켜져 있는 보드 → 끌 틱
+    uint64_t current_tick = 0;                  // 처리를 마친 마지막 틱
+    deque<pair<int, uint8_t>> commands;         // 보낼 명령 (보드 id, 명령)
+    bool stopping = false;
+    thread scheduler_thread;
+};
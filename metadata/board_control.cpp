@@ -2,7 +2,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <termios.h>
-#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <sys/select.h>
+#include "../logger.hpp"
 
 #define DLE 0x10
 #define STX 0x02
@@ -17,20 +20,25 @@ uint16_t crc16(const std::vector<uint8_t>& data);
 uint16_t reverse16(uint16_t val, int bits);
 
 BoardController::BoardController(const std::string& device, int board_id)
-    : id(board_id)
+    : id(board_id), device(device)
 {
-    open_port(device);
+    open_port();
 }
 
 BoardController::~BoardController() {
-    close(fd);
+    close_port();
 }
 
-void BoardController::open_port(const std::string& device) {
+bool BoardController::reconnect() {
+    close_port();
+    return open_port();
+}
+
+bool BoardController::open_port() {
     fd = open(device.c_str(), O_RDWR | O_NOCTTY);
     if (fd < 0) {
-        perror("open");
-        exit(1);
+        LOG_ERROR("[Board " << id << "] " << device << " 열기 실패: " << strerror(errno));
+        return false;
     }
 
     termios tty{};
@@ -44,6 +52,15 @@ void BoardController::open_port(const std::string& device) {
     tty.c_cflag &= ~CSTOPB;
     tty.c_cflag &= ~CRTSCTS;
     tcsetattr(fd, TCSANOW, &tty);
+    LOG_INFO("[Board " << id << "] " << device << " 연결");
+    return true;
+}
+
+void BoardController::close_port() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
 }
 
 void BoardController::send_lcd_on() {
@@ -55,8 +72,12 @@ void BoardController::send_lcd_off() {
 }
 
 void BoardController::send_frame(uint8_t command) {
+    if (fd < 0) return;
     auto frame = encode_frame(command);
-    write(fd, frame.data(), frame.size());
+    if (write(fd, frame.data(), frame.size()) < 0) {
+        LOG_ERROR("[Board " << id << "] " << device << " 쓰기 실패: " << strerror(errno));
+        close_port();
+    }
 }
 
 //ACK/NACK 신뢰성 송신 확장
@@ -69,11 +90,17 @@ bool BoardController::send_lcd_off_with_ack(int retries, int timeout_ms) {
 }
 
 bool BoardController::send_frame_with_ack(uint8_t command, int retries, int timeout_ms) {
+    if (fd < 0) return false;
     auto frame = encode_frame(command);
     for (int attempt = 0; attempt < retries; ++attempt) {
         // flush input buffer before sending
         tcflush(fd, TCIFLUSH);
-        write(fd, frame.data(), frame.size());
+        if (write(fd, frame.data(), frame.size()) < 0) {
+            // 장치가 사라지는 등 포트 오류: 닫아 두고 호출자가 reconnect() 하도록 함
+            LOG_ERROR("[Board " << id << "] " << device << " 쓰기 실패: " << strerror(errno));
+            close_port();
+            return false;
+        }
 
         // FSM state
         enum { WAIT_DLE, WAIT_STX, IN_FRAME, WAIT_ETX } state = WAIT_DLE;
@@ -92,9 +119,19 @@ bool BoardController::send_frame_with_ack(uint8_t command, int retries, int time
             tv.tv_usec = step_ms * 1000;
 
             int ret = select(fd + 1, &readfds, NULL, NULL, &tv);
+            if (ret < 0 && errno != EINTR) {
+                LOG_ERROR("[Board " << id << "] " << device << " 대기 실패: " << strerror(errno));
+                close_port();
+                return false;
+            }
             if (ret > 0 && FD_ISSET(fd, &readfds)) {
                 uint8_t rx;
                 ssize_t n = read(fd, &rx, 1);
+                if (n < 0 && errno != EINTR && errno != EAGAIN) {
+                    LOG_ERROR("[Board " << id << "] " << device << " 읽기 실패: " << strerror(errno));
+                    close_port();
+                    return false;
+                }
                 if (n == 1) {
                     switch (state) {
                         case WAIT_DLE:
@@ -127,17 +164,17 @@ bool BoardController::send_frame_with_ack(uint8_t command, int retries, int time
                                     uint16_t calc_crc = crc16(crc_input);
                                     if (recv_crc == calc_crc) {
                                         if (resp_cmd == ACK) {
-                                            std::cout << "[Board " << id << "] ACK received" << std::endl;
+                                            LOG_DEBUG("[Board " << id << "] ACK received");
                                             return true;
                                         } else if (resp_cmd == NACK) {
-                                            std::cout << "[Board " << id << "] NACK received, retrying..." << std::endl;
+                                            LOG_WARN("[Board " << id << "] NACK received, retrying...");
                                             break;
                                         }
                                     } else {
-                                        std::cout << "[Board " << id << "] Bad CRC in response" << std::endl;
+                                        LOG_WARN("[Board " << id << "] Bad CRC in response");
                                     }
                                 } else {
-                                    std::cout << "[Board " << id << "] Bad response frame size" << std::endl;
+                                    LOG_WARN("[Board " << id << "] Bad response frame size");
                                 }
                                 // 프레임 끝, 다시 대기
                                 state = WAIT_DLE;
@@ -156,10 +193,10 @@ bool BoardController::send_frame_with_ack(uint8_t command, int retries, int time
             }
             waited += step_ms;
         }
-        std::cout << "[Board " << id << "] Timeout waiting for ACK/NACK, retrying..." << std::endl;
+        LOG_WARN("[Board " << id << "] Timeout waiting for ACK/NACK, retrying...");
         usleep(100 * 1000);
     }
-    std::cout << "[Board " << id << "] Failed to get ACK after " << retries << " attempts!" << std::endl;
+    LOG_ERROR("[Board " << id << "] Failed to get ACK after " << retries << " attempts!");
     return false;
 }
 
@@ -18,9 +18,17 @@ uint16_t reverse16(uint16_t val, int bits);
 
 class BoardController {
 public:
+    // 포트를 열어 두고 계속 사용 (열기에 실패하면 is_open() == false, reconnect() 로 다시 시도)
     BoardController(const std::string& device, int board_id);
     ~BoardController();
 
+    BoardController(const BoardController&) = delete;
+    BoardController& operator=(const BoardController&) = delete;
+
+    bool is_open() const { return fd >= 0; }
+    // 포트를 닫았다가 다시 열고 설정 (성공하면 true)
+    bool reconnect();
+
     void send_lcd_on();
     void send_lcd_off();
 
@@ -29,10 +37,12 @@ public:
     bool send_lcd_off_with_ack(int retries = 3, int timeout_ms = 1000);
     
 private:
-    int fd;
+    int fd = -1;
     int id;
+    std::string device;
 
-    void open_port(const std::string& device);
+    bool open_port();
+    void close_port();
     void send_frame(uint8_t command);
 
     // 확장: ACK/NACK 신뢰성 송신
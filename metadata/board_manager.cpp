@@ -0,0 +1,82 @@
+#include "board_manager.hpp"
+#include "../logger.hpp"
+
+BoardManager::BoardManager(const vector<pair<int, string>>& boards) {
+    for (const auto& [board_id, port] : boards) {
+        auto session = make_unique<Session>();
+        session->board_id = board_id;
+        session->port = port;
+        // 열기에 실패해도 세션은 만들어 두고 첫 명령 때 다시 연결
+        session->controller = make_unique<BoardController>(port, board_id);
+        session->sender_thread = thread(&BoardManager::run, ref(*session));
+        sessions.emplace(board_id, move(session));
+    }
+}
+
+BoardManager::~BoardManager() {
+    stop();
+}
+
+bool BoardManager::submit(int board_id, uint8_t cmd) {
+    auto it = sessions.find(board_id);
+    if (it == sessions.end()) return false;
+
+    Session& session = *it->second;
+    {
+        lock_guard<mutex> lock(session.queue_mutex);
+        if (session.stopping) return false;
+        session.commands.push_back(cmd);
+    }
+    session.queue_not_empty.notify_one();
+    return true;
+}
+
+void BoardManager::stop() {
+    for (auto& [board_id, session] : sessions) {
+        {
+            lock_guard<mutex> lock(session->queue_mutex);
+            session->stopping = true;
+        }
+        session->queue_not_empty.notify_all();
+    }
+    for (auto& [board_id, session] : sessions) {
+        if (session->sender_thread.joinable()) session->sender_thread.join();
+    }
+}
+
+void BoardManager::run(Session& session) {
+    while (true) {
+        uint8_t cmd;
+        {
+            unique_lock<mutex> lock(session.queue_mutex);
+            session.queue_not_empty.wait(lock, [&session] { return session.stopping || !session.commands.empty(); });
+            if (session.commands.empty()) return; // 종료 요청이고 남은 명령이 없음
+            cmd = session.commands.front();
+            session.commands.pop_front();
+        }
+        send_command(session, cmd);
+    }
+}
+
+void BoardManager::send_command(Session& session, uint8_t cmd) {
+    BoardController& controller = *session.controller;
+
+    // 포트 오류로 닫혔으면 다시 연결해서 한 번 더 보냄 (응답 없음/NACK 은 포트가 열려 있으므로 재연결하지 않음)
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (!controller.is_open() && !controller.reconnect()) break;
+
+        bool ok = false;
+        if (cmd == CMD_LCD_ON) {
+            ok = controller.send_lcd_on_with_ack(BOARD_COMMAND_RETRIES, BOARD_COMMAND_TIMEOUT_MS);
+        } else if (cmd == CMD_LCD_OFF) {
+            ok = controller.send_lcd_off_with_ack(BOARD_COMMAND_RETRIES, BOARD_COMMAND_TIMEOUT_MS);
+        }
+
+        if (ok) {
+            LOG_INFO("Command 0x" << hex << int(cmd) << dec << " succeeded for board " << session.board_id);
+            return;
+        }
+        if (controller.is_open()) break;
+    }
+    LOG_ERROR("Command 0x" << hex << int(cmd) << dec << " failed for board " << session.board_id << " (" << session.port << ")");
+}
@@ -0,0 +1,59 @@
+// 보드 UART 세션 관리
+// board_info 의 보드마다 BoardController 를 하나씩 열어 두고 계속 사용한다. (명령마다 tty 를 열고 termios 를 설정하지 않음)
+// 보드마다 명령 대기열과 전용 스레드가 있어 한 포트의 명령은 순서대로 하나씩 보내고, 다른 보드의 ACK 대기에 막히지 않는다.
+// 포트가 열려 있지 않거나 송수신 오류로 닫히면 다음 명령 때 다시 연결한다.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include "board_control.h"
+
+using namespace std;
+
+// 명령 하나의 ACK 재시도 설정 (기존 control_board 와 같은 값)
+const int BOARD_COMMAND_RETRIES = 3;
+const int BOARD_COMMAND_TIMEOUT_MS = 500;
+
+class BoardManager {
+public:
+    // boards: (보드 id, 포트 경로) 목록, 보드마다 포트를 열고 전송 스레드 시작
+    explicit BoardManager(const vector<pair<int, string>>& boards);
+    // 대기열에 남은 명령을 모두 보낸 뒤 종료
+    ~BoardManager();
+
+    BoardManager(const BoardManager&) = delete;
+    BoardManager& operator=(const BoardManager&) = delete;
+
+    // 보드 명령을 대기열에 넣고 바로 반환 (모르는 보드 id 이거나 종료 중이면 false)
+    bool submit(int board_id, uint8_t cmd);
+
+    // 새 명령을 받지 않고 남은 명령을 보낸 뒤 전송 스레드 종료 (여러 번 호출해도 됨)
+    void stop();
+
+private:
+    struct Session {
+        int board_id;
+        string port;
+        unique_ptr<BoardController> controller;
+
+        mutex queue_mutex;
+        condition_variable queue_not_empty;
+        deque<uint8_t> commands;
+        bool stopping = false;
+        thread sender_thread;
+    };
+
+    static void run(Session& session);
+    static void send_command(Session& session, uint8_t cmd);
+
+    unordered_map<int, unique_ptr<Session>> sessions;
+};
@@ -0,0 +1,47 @@
+#include "ffmpeg_metadata_source.hpp"
+#include "../logger.hpp"
+
+#include <cstdio>
+
+static const string STREAM_END_TAG = "</tt:MetadataStream>"; // 메타데이터 문서 하나의 끝
+
+FfmpegMetadataSource::FfmpegMetadataSource(const string& rtsp_url, MetadataCallback callback)
+    : rtsp_url(rtsp_url), callback(move(callback)) {
+}
+
+bool FfmpegMetadataSource::run() {
+    const string cmd = "ffmpeg -i " + rtsp_url + " -map 0:1 -f data - 2>/dev/null";
+
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe) {
+        LOG_ERROR("Failed to open ffmpeg pipe");
+        return false;
+    }
+
+    constexpr int BUFFER_SIZE = 8192;
+    char buffer[BUFFER_SIZE];
+    string xml_buffer;
+    size_t searched = 0;                    // xml_buffer 에서 종료 태그를 이미 찾아본 길이
+
+    while (fgets(buffer, BUFFER_SIZE, pipe)) {
+        xml_buffer += buffer;
+
+        // XML 블럭 완성 여부 확인 (이번에 붙인 부분과 그 직전만 검색)
+        size_t end = xml_buffer.find(STREAM_END_TAG, searched > STREAM_END_TAG.size() ? searched - STREAM_END_TAG.size() : 0);
+        if (end == string::npos) {
+            searched = xml_buffer.size();
+            if (xml_buffer.size() > METADATA_DOCUMENT_MAX_SIZE) {
+                LOG_WARN("메타데이터 문서가 " << METADATA_DOCUMENT_MAX_SIZE << " 바이트를 넘어 버립니다.");
+                xml_buffer.clear();
+                searched = 0;
+            }
+            continue;
+        }
+
+        callback(xml_buffer, 0);
+        xml_buffer.clear();
+        searched = 0;
+    }
+
+    return pclose(pipe) == 0;
+}
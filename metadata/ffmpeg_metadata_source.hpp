@@ -0,0 +1,28 @@
+// ONVIF 메타데이터 수신 모듈 (ffmpeg 파이프)
+// ffmpeg 로 카메라 RTSP 의 메타데이터 트랙(0:1)을 stdout 으로 뽑아 줄 단위로 읽고,
+// </tt:MetadataStream> 종료 태그가 나올 때마다 문서 하나를 콜백으로 넘긴다.
+// GStreamer 수신(MetadataSource)을 실제 카메라와 metadata_replay 로 검증하기 전까지의 기본 수신 방식
+// (-DMETADATA_GSTREAMER 로 빌드하면 MetadataSource 를 씀, main_control.cpp 의 빌드 명령 참고)
+
+#pragma once
+
+#include <string>
+
+#include "metadata_document.hpp"
+
+using namespace std;
+
+class FfmpegMetadataSource {
+public:
+    FfmpegMetadataSource(const string& rtsp_url, MetadataCallback callback);
+
+    FfmpegMetadataSource(const FfmpegMetadataSource&) = delete;
+    FfmpegMetadataSource& operator=(const FfmpegMetadataSource&) = delete;
+
+    // ffmpeg 가 끝날 때까지 문서를 읽어 콜백 호출. ffmpeg 를 실행하지 못했거나 비정상 종료면 false
+    bool run();
+
+private:
+    const string rtsp_url;
+    MetadataCallback callback;
+};
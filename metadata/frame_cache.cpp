@@ -0,0 +1,40 @@
+#include "frame_cache.hpp"
+
+FrameCache::FrameCache(size_t capacity) : frames(capacity > 0 ? capacity : 1) {}
+
+void FrameCache::push(const OnvifFrame& frame) {
+    CachedFrame& cached = slot(next_sequence);
+
+    // 덮어쓸 프레임 이후로 다시 나오지 않은 객체는 이제 캐시에 없음
+    if (next_sequence >= frames.size()) {
+        for (const auto& object : cached.objects) {
+            auto it = last_seen.find(object.id);
+            if (it != last_seen.end() && it->second.sequence == cached.sequence) {
+                last_seen.erase(it);
+            }
+        }
+    }
+
+    cached.sequence = next_sequence;
+    cached.utc_time.assign(frame.utc_time.data(), frame.utc_time.size());
+    cached.objects.resize(frame.objects.size());
+    for (size_t i = 0; i < frame.objects.size(); i++) {
+        const OnvifObject& source = frame.objects[i];
+        CachedObject& object = cached.objects[i];
+        object.id = source.id;
+        object.type.assign(source.type.data(), source.type.size());
+        object.has_center = source.has_center;
+        object.center_x = source.center_x;
+        object.center_y = source.center_y;
+        last_seen[source.id] = ObjectRef{next_sequence, i};
+    }
+    next_sequence++;
+}
+
+const CachedFrame* FrameCache::last_frame_with(int object_id, const CachedObject** object) const {
+    auto it = last_seen.find(object_id);
+    if (it == last_seen.end()) return nullptr;
+    const CachedFrame& frame = slot(it->second.sequence);
+    if (object != nullptr) *object = &frame.objects[it->second.index];
+    return &frame;
+}
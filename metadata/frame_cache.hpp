@@ -0,0 +1,59 @@
+// 최근 프레임 캐시
+// 파싱한 프레임(UtcTime, 객체 id, 타입, 중심점)을 고정 크기 링 버퍼에 보관하고,
+// 객체 id → 마지막으로 나온 프레임 색인을 함께 유지해 "캐시에 남아 있는가", "마지막으로 어떤 타입이었나" 를 해시 조회 한 번으로 답한다.
+// 링 버퍼 칸과 그 안의 vector/string 은 덮어쓸 때 재사용하므로, 객체 수가 비슷하면 프레임마다 새로 할당하지 않는다.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "onvif_parser.hpp"
+
+using namespace std;
+
+struct CachedObject {
+    int id = -1;
+    string type;
+    bool has_center = false;
+    float center_x = 0;
+    float center_y = 0;
+};
+
+struct CachedFrame {
+    uint64_t sequence = 0;          // 캐시에 들어온 순번 (0 부터)
+    string utc_time;
+    vector<CachedObject> objects;
+};
+
+class FrameCache {
+public:
+    explicit FrameCache(size_t capacity);
+
+    // 프레임을 복사해 넣음 (가득 차면 가장 오래된 프레임을 덮어쓰고, 그 뒤로 나오지 않은 객체는 색인에서 제거)
+    void push(const OnvifFrame& frame);
+
+    // 캐시에 남은 프레임 중 하나라도 object_id 가 있으면 true
+    bool contains(int object_id) const { return last_seen.count(object_id) != 0; }
+
+    // object_id 가 마지막으로 나온 프레임 (없으면 nullptr), object 에 그 프레임의 객체를 돌려줌
+    const CachedFrame* last_frame_with(int object_id, const CachedObject** object = nullptr) const;
+
+    size_t size() const { return next_sequence < frames.size() ? next_sequence : frames.size(); }
+
+private:
+    // 객체가 마지막으로 나온 위치
+    struct ObjectRef {
+        uint64_t sequence;
+        size_t index;               // CachedFrame::objects 안의 위치
+    };
+
+    CachedFrame& slot(uint64_t sequence) { return frames[sequence % frames.size()]; }
+    const CachedFrame& slot(uint64_t sequence) const { return frames[sequence % frames.size()]; }
+
+    vector<CachedFrame> frames;
+    uint64_t next_sequence = 0;
+    unordered_map<int, ObjectRef> last_seen;
+};
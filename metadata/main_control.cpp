@@ -1,7 +1,6 @@
 #include <iostream>
 #include <unordered_map>
 #include <string>
-#include <regex>
 #include <cmath>
 #include <mutex>
 #include <cstdio>
@@ -17,6 +16,23 @@
 #include <unistd.h>
 #include <SQLiteCpp/SQLiteCpp.h>
 #include "board_control.h"
+#include "board_manager.hpp"
+#include "../statement_cache.hpp"
+#include "../image_store.hpp"
+#include "../thumbnail.hpp"
+#include "../detection_writer.hpp"
+#include "../logger.hpp"
+#include "onvif_parser.hpp"
+#include "frame_cache.hpp"
+#include "alert_scheduler.hpp"
+#include "screen_capturer.hpp"
+// 메타데이터 수신 방식 (GStreamer 수신은 metadata_replay 와 실제 카메라로 검증하기 전까지 빌드 옵션)
+#ifdef METADATA_GSTREAMER
+#include "metadata_source.hpp"
+#else
+#include "ffmpeg_metadata_source.hpp"
+using MetadataSource = FfmpegMetadataSource;
+#endif
 
 using namespace std;
 
@@ -42,18 +58,24 @@ std::vector<std::pair<int, std::string>> board_info = {
     {4, "/dev/ttyAMA3"}
 };
 
-// 보드 ID → 포트 경로 조회 함수
-std::string get_uart_port_for_board(int board_id) {
-    for (const auto& [id, port] : board_info) {
-        if (id == board_id) return port;
-    }
-    return "";
-}
-
 // --- 전역 상태 ---
 recursive_mutex data_mutex;
 const string RTSP_URL = "rtsp://admin:admin123@@192.168.0.137:554/0/onvif/profile2/media.smp";
 const string DB_FILE = "../server_log.db";
+const string IMAGE_STORE_DIR = "../images"; // 서버의 감지 이미지 저장소 (DB 에는 해시만 기록)
+
+// 감지 이미지 저장소 (main 에서 생성)
+unique_ptr<ImageStore> image_store;
+// 목록 조회용 썸네일 설정 (서버와 같은 환경변수 THUMBNAIL_WIDTH, THUMBNAIL_QUALITY)
+ThumbnailOptions thumbnail_options;
+// 감지 이미지 비동기 저장 (main 에서 생성, 메타데이터 처리 스레드는 디스크 쓰기를 기다리지 않음)
+unique_ptr<DetectionWriter> detection_writer;
+// 보드별 UART 세션 (main 에서 생성, 포트를 계속 열어 두고 보드마다 명령을 순서대로 보냄)
+unique_ptr<BoardManager> board_manager;
+// 보드 LCD 켜기/끄기 예약 (main 에서 생성, 메타데이터 처리 스레드는 보드 응답을 기다리지 않음)
+unique_ptr<AlertScheduler> alert_scheduler;
+// 경고 화면 캡처 (main 에서 생성, 메타데이터 처리 스레드는 ffmpeg 캡처를 기다리지 않음)
+unique_ptr<ScreenCapturer> screen_capturer;
 
 // DB에서 로드될 좌표 및 설정값
 vector<tuple<int, Point, int, Point>> base_line_pairs;
@@ -68,6 +90,9 @@ constexpr float parrallelism_threshold = 0.75f; // 차량 이동 방향과 라
 constexpr size_t FRAME_CACHE_SIZE = 15;
 constexpr int HISTORY_SIZE = 10; // 이동 경로 저장 사이즈
 
+// 경고 시 dot matrix LCD 를 켜 두는 시간 (마지막 경고 기준)
+constexpr chrono::milliseconds ALERT_HOLD(5000);
+
 // 객체 이동 경로를 저장하는 구조체
 struct ObjectState {
     deque<Point> history;
@@ -78,9 +103,9 @@ unordered_map<int, ObjectState> vehicle_trajectory_history;
 
 
 // --- 함수 선언 ---
-void analyze_risk_and_alert(SQLite::Database& db, int human_id, const string& rule_name, const string& utc_time_str);
+void analyze_risk_and_alert(int human_id, const string& rule_name, const string& utc_time_str);
 float compute_cosine_similarity(const Point& a, const Point& b);
-void capture_screen_and_save(SQLite::Database& db, const string& utc_time_str);
+void capture_screen_and_save(const string& utc_time_str);
 void control_board(int board_id, uint8_t cmd);
 
 
@@ -106,26 +131,10 @@ std::vector<uint8_t> encode_frame(uint8_t cmd, int board_id) {
 }
 
 
-// 보드 제어 함수
+// 보드 제어 함수 (보드별 UART 세션의 대기열에 넣고 바로 반환, 결과는 세션 스레드가 로그로 남김)
 void control_board(int board_id, uint8_t cmd) {
-    std::string port = get_uart_port_for_board(board_id);
-    if (port.empty()) {
-        cerr << "[ERROR] Unknown board ID: " << board_id << endl;
-        return;
-    }
-
-    BoardController controller(port, board_id);
-    bool ok = false;
-    if (cmd == CMD_LCD_ON) {
-        ok = controller.send_lcd_on_with_ack(3, 500); // 3회 재시도, 500ms 타임아웃
-    } else if (cmd == CMD_LCD_OFF) {
-        ok = controller.send_lcd_off_with_ack(3, 500);
-    }
-
-    if (ok) {
-        cout << "[INFO] Command 0x" << hex << int(cmd) << " succeeded for board " << board_id << endl;
-    } else {
-        cerr << "[ERROR] Command 0x" << hex << int(cmd) << " failed for board " << board_id << endl;
+    if (!board_manager->submit(board_id, cmd)) {
+        LOG_ERROR("Unknown board ID: " << board_id);
     }
 }
 
@@ -139,20 +148,23 @@ void create_detections_table(SQLite::Database& db) {
             "id INTEGER PRIMARY KEY AUTOINCREMENT, "
             "image BLOB, "
             "timestamp DATETIME NOT NULL)");
-    cout << "[INFO] 'detections' table is ready." << endl;
+    // 서버의 스키마 버전 3, 4, 5 에서 추가된 컬럼 (서버보다 먼저 실행된 경우를 위해 여기서도 확인)
+    // ts_ms: 조회용 epoch 밀리초, image_hash/image_size: 이미지 저장소 참조, thumb_hash/thumb_size: 썸네일 참조
+    for (const auto& [column, type] : vector<pair<string, string>>{{"ts_ms", "INTEGER"}, {"image_hash", "TEXT"}, {"image_size", "INTEGER"},
+                                                                   {"thumb_hash", "TEXT"}, {"thumb_size", "INTEGER"}}) {
+        if (!db.execAndGet("SELECT COUNT(*) FROM pragma_table_info('detections') WHERE name = '" + column + "'").getInt()) {
+            db.exec("ALTER TABLE detections ADD COLUMN " + column + " " + type);
+        }
+    }
+    db.exec("CREATE INDEX IF NOT EXISTS idx_detections_ts_ms ON detections (ts_ms)");
+    LOG_INFO("'detections' table is ready.");
 }
 
-// DB에 이미지 삽입
-void insert_data(SQLite::Database& db, const vector<unsigned char>& image_data, const string& timestamp) {
-    try {
-        SQLite::Statement query(db, "INSERT INTO detections (image, timestamp) VALUES (?, ?)");
-        query.bind(1, image_data.data(), image_data.size());
-        query.bind(2, timestamp);
-        query.exec();
-        cout << "[INFO] Image data inserted to DB with timestamp: " << timestamp << endl;
-    } catch (const exception& e) {
-        cerr << "[ERROR] Failed to insert data into DB: " << e.what() << endl;
-    }
+// 이미지와 썸네일은 이미지 저장소에 쓰고 DB 에는 해시와 크기만 삽입 (timestamp: 표시용 KST 문자열, ts_ms: 조회용 UTC epoch 밀리초)
+// 저장은 DetectionWriter 쓰기 스레드에서 묶어서 처리하고 바로 반환 (future 로 행 id 확인 가능, 실패는 쓰기 스레드가 로그로 남김)
+future<int64_t> insert_data(vector<unsigned char> image_data, const string& timestamp, int64_t ts_ms) {
+    LOG_INFO("Image data queued for DB with timestamp: " << timestamp);
+    return detection_writer->submit(move(image_data), timestamp, ts_ms);
 }
 
 // 점과 점으로 이루어진 두 직선의 교차점 구하는 함수, dot_center 구하기
@@ -176,8 +188,8 @@ bool calculate_intersection(const Point& a1, const Point& a2,
 }
 
 // DB에서 Dots(보조선) 좌표 로드 및 dot_center 계산
-void load_dots_and_center(SQLite::Database& db) {
-    cout << "[INFO] Loading baseLines from DB..." << endl;
+void load_dots_and_center(DbHandle& db) {
+    LOG_INFO("Loading baseLines from DB...");
 
     const float scale_x = 3840.0f / 960.0f;
     const float scale_y = 2160.0f / 540.0f;
@@ -187,18 +199,18 @@ void load_dots_and_center(SQLite::Database& db) {
     base_line_pairs.clear();
 
     try {
-        SQLite::Statement query(db, "SELECT matrixNum1, x1, y1, matrixNum2, x2, y2 FROM baseLines");
+        auto query = db.prepare("SELECT matrixNum1, x1, y1, matrixNum2, x2, y2 FROM baseLines");
 
-        while (query.executeStep()) {
-            int id1 = query.getColumn(0).getInt();
-            Point p1 = {query.getColumn(1).getInt() * scale_x, query.getColumn(2).getInt() * scale_y};
-            int id2 = query.getColumn(3).getInt();
-            Point p2 = {query.getColumn(4).getInt() * scale_x, query.getColumn(5).getInt() * scale_y};
+        while (query->executeStep()) {
+            int id1 = query->getColumn(0).getInt();
+            Point p1 = {query->getColumn(1).getInt() * scale_x, query->getColumn(2).getInt() * scale_y};
+            int id2 = query->getColumn(3).getInt();
+            Point p2 = {query->getColumn(4).getInt() * scale_x, query->getColumn(5).getInt() * scale_y};
 
             base_line_pairs.emplace_back(id1, p1, id2, p2);
 
-            cout << "[DEBUG] Loaded dot pair: " << id1 << "<->" << id2
-                 << " (" << p1.x << "," << p1.y << ") <-> (" << p2.x << "," << p2.y << ")" << endl;
+            LOG_DEBUG("Loaded dot pair: " << id1 << "<->" << id2
+                      << " (" << p1.x << "," << p1.y << ") <-> (" << p2.x << "," << p2.y << ")");
         }
 
         // dot_center 계산
@@ -221,57 +233,81 @@ void load_dots_and_center(SQLite::Database& db) {
                 (get<1>(base_line_pairs[0]).y + get<3>(base_line_pairs[0]).y) / 2
             };
         } else {
-            cerr << "[WARNING] No baseLines found. dot_center = (0, 0)" << endl;
+            LOG_WARN("No baseLines found. dot_center = (0, 0)");
         }
 
-        cout << "[INFO] Calculated dot_center: (" << dot_center.x << ", " << dot_center.y << ")" << endl;
+        LOG_INFO("Calculated dot_center: (" << dot_center.x << ", " << dot_center.y << ")");
 
     } catch (const exception& e) {
-        cerr << "[ERROR] Failed to load baseLines: " << e.what() << endl;
+        LOG_ERROR("Failed to load baseLines: " << e.what());
     }
 }
 
 
 // DB에서 Rule Lines(가상선) 정보 로드
-void load_rule_lines(SQLite::Database& db) {
-    cout << "[INFO] Loading rule lines from DB..." << endl;
+void load_rule_lines(DbHandle& db) {
+    LOG_INFO("Loading rule lines from DB...");
 
     const float scale_x = 3840.0f / 960.0f;
     const float scale_y = 2160.0f / 540.0f;
+    // 삭제된 감지선이 남지 않도록 비우고 다시 채움
+    rule_lines.clear();
 
     try {
-        SQLite::Statement query(db, "SELECT x1, y1, x2, y2, name, mode FROM lines LIMIT 8");
+        auto query = db.prepare("SELECT x1, y1, x2, y2, name, mode FROM lines LIMIT 8");
 
-        while (query.executeStep()) {
+        while (query->executeStep()) {
             Line line;
-            line.start = { query.getColumn(0).getInt() * scale_x, query.getColumn(1).getInt() * scale_y };
-            line.end   = { query.getColumn(2).getInt() * scale_x, query.getColumn(3).getInt() * scale_y };
-            line.name = query.getColumn(4).getString();
-            line.mode = query.getColumn(5).getString();
+            line.start = { query->getColumn(0).getInt() * scale_x, query->getColumn(1).getInt() * scale_y };
+            line.end   = { query->getColumn(2).getInt() * scale_x, query->getColumn(3).getInt() * scale_y };
+            line.name = query->getColumn(4).getString();
+            line.mode = query->getColumn(5).getString();
 
             rule_lines[line.name] = line;
 
-            cout << "[DEBUG] Loaded line (scaled): " << line.name
-                 << " [(" << line.start.x << "," << line.start.y << ") -> ("
-                 << line.end.x << "," << line.end.y << ")] Mode: " << line.mode << endl;
+            LOG_DEBUG("Loaded line (scaled): " << line.name
+                      << " [(" << line.start.x << "," << line.start.y << ") -> ("
+                      << line.end.x << "," << line.end.y << ")] Mode: " << line.mode);
         }
 
         if (rule_lines.empty()) {
-            cerr << "[WARNING] No rule lines found in DB. 'rule_lines' is empty." << endl;
+            LOG_WARN("No rule lines found in DB. 'rule_lines' is empty.");
         }
 
     } catch (const std::exception& e) {
-        cerr << "[ERROR] Failed to load from 'lines' table: " << e.what() << endl;
+        LOG_ERROR("Failed to load from 'lines' table: " << e.what());
     }
 }
 
 
+// 설정(lines, baseLines)이 마지막으로 읽은 뒤 바뀌었는지 확인
+// 다른 연결의 커밋 여부는 PRAGMA data_version 으로 디스크 I/O 없이 확인하고, 커밋이 있었을 때만
+// 서버가 관리하는 config_version (두 테이블 변경 시 트리거로 증가) 을 읽음. config_version 이 없는 DB 면 커밋마다 true
+bool config_changed(DbHandle& db) {
+    static int64_t last_data_version = -1;
+    static int64_t last_config_version = -1;
+
+    int64_t data_version = db.execAndGet("PRAGMA data_version").getInt64();
+    if (data_version == last_data_version) return false;
+    last_data_version = data_version;
+
+    try {
+        int64_t config_version = db.execAndGet("SELECT version FROM config_version WHERE id = 1").getInt64();
+        if (config_version == last_config_version) return false;
+        last_config_version = config_version;
+    } catch (const SQLite::Exception&) {
+        // 서버가 아직 스키마 버전 7 을 적용하지 않음
+    }
+    return true;
+}
+
+
 // --- 핵심 로직 함수 ---
 
-// 화면을 캡처하고 DB에 저장
-void capture_screen_and_save(SQLite::Database& db, const string& utc_time_str) {
+// 화면을 캡처하고 DB에 저장 (ScreenCapturer 스레드에서 실행)
+void capture_screen_and_save(const string& utc_time_str) {
     if (utc_time_str.empty()) {
-        cerr << "[ERROR] Cannot capture screen. UTC time is empty." << endl;
+        LOG_ERROR("Cannot capture screen. UTC time is empty.");
         return;
     }
 
@@ -280,13 +316,13 @@ void capture_screen_and_save(SQLite::Database& db, const string& utc_time_str) {
     std::stringstream ss(utc_time_str);
     ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
     if (ss.fail()) {
-        cerr << "[ERROR] Failed to parse UTC time string: " << utc_time_str << endl;
+        LOG_ERROR("Failed to parse UTC time string: " << utc_time_str);
         return;
     }
 
     time_t time_utc = timegm(&tm);
     if (time_utc == -1) {
-        cerr << "[ERROR] Failed to convert UTC tm to time_t." << endl;
+        LOG_ERROR("Failed to convert UTC tm to time_t.");
         return;
     }
 
@@ -300,12 +336,12 @@ void capture_screen_and_save(SQLite::Database& db, const string& utc_time_str) {
     // 2. ffmpeg 캡처 명령어 생성 (이미지를 stdout으로 출력)
     string cmd = "ffmpeg -i " + RTSP_URL + " -vframes 1 -c:v mjpeg -f image2pipe - 2>/dev/null";
     
-    cout << "[INFO] Capturing screen to save into database..." << endl;
+    LOG_INFO("Capturing screen to save into database...");
 
     // 3. ffmpeg 실행 및 이미지 데이터 읽기
     FILE* pipe = popen(cmd.c_str(), "r");
     if (!pipe) {
-        cerr << "[ERROR] Failed to open ffmpeg pipe for capture." << endl;
+        LOG_ERROR("Failed to open ffmpeg pipe for capture.");
         return;
     }
 
@@ -319,90 +355,39 @@ void capture_screen_and_save(SQLite::Database& db, const string& utc_time_str) {
 
     // 4. DB에 데이터 삽입
     if (!image_data.empty()) {
-        insert_data(db, image_data, kst_timestamp_str);
+        insert_data(move(image_data), kst_timestamp_str, static_cast<int64_t>(time_utc) * 1000);
     } else {
-        cerr << "[ERROR] Failed to read image data from ffmpeg pipe." << endl;
+        LOG_ERROR("Failed to read image data from ffmpeg pipe.");
     }
 }
 
 
-// 블럭 내에 VideoAnalytics 프레임이 포함되어 있는지 확인
-bool contains_frame_block(const string& block) {
-    return block.find("<tt:VideoAnalytics>") != string::npos &&
-           block.find("<tt:Frame") != string::npos;
-}
-
-// 라인크로싱 이벤트 블럭인지 확인하고 ObjectId와 RuleName을 추출
-bool is_linecrossing_event(const string& event_block, string& object_id, string& rule_name) {
-    regex topic_regex("<wsnt:Topic[^>]*>([^<]*)</wsnt:Topic>");
-    smatch topic_match;
-    if (!regex_search(event_block, topic_match, topic_regex) || string(topic_match[1]).find("LineCrossing") == string::npos) {
+// object_id 가 마지막으로 나온 프레임에서 Human 이면 그 프레임의 UtcTime 을 반환 (frame_cache 에는 현재 프레임까지 들어 있음)
+bool find_human_frame(int object_id, const FrameCache& frame_cache, string& utc_time_str) {
+    const CachedObject* object = nullptr;
+    const CachedFrame* frame = frame_cache.last_frame_with(object_id, &object);
+    if (frame == nullptr || object->type != "Human") {
         return false;
     }
-
-    regex id_regex("<tt:SimpleItem Name=\"ObjectId\" Value=\"(\\d+)\"/>");
-    regex rule_regex("<tt:SimpleItem Name=\"RuleName\" Value=\"([^\"]+)\"/>");
-    regex state_regex("<tt:SimpleItem Name=\"State\" Value=\"true\"");
-
-    smatch match;
-    bool id_ok = regex_search(event_block, match, id_regex);
-    if (id_ok) object_id = match[1];
-
-    bool rule_ok = regex_search(event_block, match, rule_regex);
-    if (rule_ok) rule_name = match[1];
-
-    bool state_ok = regex_search(event_block, match, state_regex);
-
-    if (id_ok && rule_ok && state_ok) {
-        cout << "[DEBUG] LineCrossing Event: ObjectId=" << object_id << ", RuleName=" << rule_name << endl;
-        return true;
-    }
-    return false;
-}
-
-// ObjectId로 객체 타입이 Human인지 확인
-bool is_human(const string& block, const string& object_id) {
-    regex object_block_regex("<tt:Object ObjectId=\"" + object_id + "\"[\\s\\S]*?<tt:Type[^>]*>([^<]*)</tt:Type>");
-    smatch match;
-    if (regex_search(block, match, object_block_regex)) {
-        string type = match[1];
-        return type == "Human";
-    }
-    return false;
+    utc_time_str = frame->utc_time;
+    return true;
 }
 
-// 프레임에서 차량 위치 업데이트
-void update_vehicle_positions(const string& frame_block, const deque<string>& frame_cache) {
-    //cout << "[DEBUG] Entering update_vehicle_positions()" << endl;
-
+// 프레임에서 차량 위치 업데이트 (frame 은 frame_cache 에 방금 넣은 현재 프레임)
+void update_vehicle_positions(const OnvifFrame& frame, const FrameCache& frame_cache) {
     unordered_map<int, bool> seen_vehicles;
 
-    // [1] Object 블럭 단위로 분리
-    regex object_block_regex("<tt:Object ObjectId=\"(\\d+)\">([\\s\\S]*?)</tt:Object>");
-    auto block_begin = sregex_iterator(frame_block.begin(), frame_block.end(), object_block_regex);
-    auto block_end = sregex_iterator();
-
-    for (auto it = block_begin; it != block_end; ++it) {
-        int id = stoi((*it)[1]);
-        string object_content = (*it)[2].str();
-
-        // [2] 타입 추출
-        smatch type_match;
-        if (!regex_search(object_content, type_match, regex("<tt:Type[^>]*>([^<]*)</tt:Type>")))
+    for (const auto& object : frame.objects) {
+        // [1] 타입이 차량이고 CenterOfGravity 가 있는 객체만 추적
+        if (object.type != "Vehicle" && object.type != "Vehical")
             continue;
-
-        string type = type_match[1];
-        if (type != "Vehicle" && type != "Vehical")
+        if (!object.has_center)
             continue;
 
-        // [3] CenterOfGravity 추출
-        smatch cog_match;
-        if (!regex_search(object_content, cog_match, regex("<tt:CenterOfGravity[^>]*x=\"([\\d.]+)\" y=\"([\\d.]+)\"")))
-            continue;
-
-        Point cog = {stof(cog_match[1]), stof(cog_match[2])};
+        int id = object.id;
+        Point cog = {object.center_x, object.center_y};
 
-        cout << "[DEBUG] Tracking Vehicle " << id << " at (" << cog.x << ", " << cog.y << ")" << endl;
+        LOG_DEBUG("Tracking Vehicle " << id << " at (" << cog.x << ", " << cog.y << ")");
 
         seen_vehicles[id] = true;
         auto& state = vehicle_trajectory_history[id];
@@ -415,16 +400,9 @@ void update_vehicle_positions(const string& frame_block, const deque<string>& fr
     // [4] 캐시를 기반으로 사라진 차량 객체 정리
     for (auto it = vehicle_trajectory_history.begin(); it != vehicle_trajectory_history.end(); ) {
         if (seen_vehicles.find(it->first) == seen_vehicles.end()) {
-            bool found_in_cache = false;
-            for (const auto& cached_frame : frame_cache) {
-                if (cached_frame.find("<tt:Object ObjectId=\"" + to_string(it->first) + "\"") != string::npos) {
-                    found_in_cache = true;
-                    break;
-                }
-            }
-
-            if (!found_in_cache) {
-                cout << "[DEBUG] Vehicle " << it->first << " disappeared from all cache frames. Erasing." << endl;
+            // 현재 프레임이나 캐시된 프레임에 남아 있으면 유지
+            if (!frame_cache.contains(it->first)) {
+                LOG_DEBUG("Vehicle " << it->first << " disappeared from all cache frames. Erasing.");
                 it = vehicle_trajectory_history.erase(it);
             } else {
                 ++it;
@@ -433,19 +411,17 @@ void update_vehicle_positions(const string& frame_block, const deque<string>& fr
             ++it;
         }
     }
-
-    //cout << "[DEBUG] Exiting update_vehicle_positions()" << endl;
 }
 
 // 위험 분석 및 경고 로직
-void analyze_risk_and_alert(SQLite::Database& db, int human_id, const string& rule_name, const string& utc_time_str) {
+void analyze_risk_and_alert(int human_id, const string& rule_name, const string& utc_time_str) {
     lock_guard<recursive_mutex> lock(data_mutex);
 
-    cout << "[DEBUG] Analyzing risk for human_id: " << human_id << " crossing line: " << rule_name << endl;
+    LOG_DEBUG("Analyzing risk for human_id: " << human_id << " crossing line: " << rule_name);
 
     // 1. 이벤트 라인 정보 확인
     if (rule_lines.find(rule_name) == rule_lines.end()) {
-        cout << "[DEBUG] Step Failed: RuleName '" << rule_name << "' not found in predefined lines." << endl;
+        LOG_DEBUG("Step Failed: RuleName '" << rule_name << "' not found in predefined lines.");
         return;
     }
 
@@ -456,18 +432,18 @@ void analyze_risk_and_alert(SQLite::Database& db, int human_id, const string& ru
     };
 
     // 2. 차량 이력 존재 확인
-    cout << "[DEBUG] Vehicle history size: " << vehicle_trajectory_history.size() << endl;
+    LOG_DEBUG("Vehicle history size: " << vehicle_trajectory_history.size());
     if (vehicle_trajectory_history.empty()) {
-        cout << "[DEBUG] Step Failed: No vehicles detected to analyze." << endl;
+        LOG_DEBUG("Step Failed: No vehicles detected to analyze.");
         return;
     }
 
     // 3. 각 차량 반복
     for (const auto& [vehicle_id, vehicle_state] : vehicle_trajectory_history) {
-        cout << "[DEBUG] Vehicle " << vehicle_id << " history size: " << vehicle_state.history.size() << endl;
+        LOG_DEBUG("Vehicle " << vehicle_id << " history size: " << vehicle_state.history.size());
 
         if (vehicle_state.history.size() < 2) {
-            cout << "[DEBUG] Vehicle " << vehicle_id << ": Insufficient history. Skipping." << endl;
+            LOG_DEBUG("Vehicle " << vehicle_id << ": Insufficient history. Skipping.");
             continue;
         }
 
@@ -500,17 +476,17 @@ void analyze_risk_and_alert(SQLite::Database& db, int human_id, const string& ru
             }
         }
 
-        cout << "[DEBUG] Vehicle " << vehicle_id << ": Closest dot = (" << closest_dot.x << "," << closest_dot.y << ")" << endl;
-        cout << "[DEBUG] Oldest Pos = (" << oldest_pos.x << "," << oldest_pos.y << "), Newest Pos = (" << newest_pos.x << "," << newest_pos.y << ")" << endl;
+        LOG_DEBUG("Vehicle " << vehicle_id << ": Closest dot = (" << closest_dot.x << "," << closest_dot.y << ")");
+        LOG_DEBUG("Oldest Pos = (" << oldest_pos.x << "," << oldest_pos.y << "), Newest Pos = (" << newest_pos.x << "," << newest_pos.y << ")");
 
         // 5. dot_center 접근 여부 확인
         float dist_old = hypot(oldest_pos.x - dot_center.x, oldest_pos.y - dot_center.y);
         float dist_new = hypot(newest_pos.x - dot_center.x, newest_pos.y - dot_center.y);
 
-        cout << "[DEBUG] Vehicle " << vehicle_id << ": Old dist to dot_center = " << dist_old << ", New dist = " << dist_new << endl;
+        LOG_DEBUG("Vehicle " << vehicle_id << ": Old dist to dot_center = " << dist_old << ", New dist = " << dist_new);
 
         if (dist_new > dist_old - dist_threshold) {
-            cout << "[DEBUG] Step Failed (Vehicle " << vehicle_id << "): Not approaching dot_center enough. Threshold = " << dist_threshold << endl;
+            LOG_DEBUG("Step Failed (Vehicle " << vehicle_id << "): Not approaching dot_center enough. Threshold = " << dist_threshold);
             continue;
         }
 
@@ -518,22 +494,19 @@ void analyze_risk_and_alert(SQLite::Database& db, int human_id, const string& ru
         Point vehicle_vector = {dot_center.x - closest_dot.x, dot_center.y - closest_dot.y};
         float similarity = compute_cosine_similarity(vehicle_vector, line_vector);
 
-        cout << "[DEBUG] Vehicle " << vehicle_id << ": Cosine similarity = " << similarity << ", Threshold = " << parrallelism_threshold << endl;
+        LOG_DEBUG("Vehicle " << vehicle_id << ": Cosine similarity = " << similarity << ", Threshold = " << parrallelism_threshold);
 
         if (abs(similarity) >= parrallelism_threshold) {
-            cout << "\n[ALERT] " << vehicle_id << " 차량이 " << human_id << " 인간을 향해 측면에서 접근 중입니다." << endl;
-            cout << board_id << " dot matrix를 가동합니다." << endl;
-            cout << "(코사인 유사도 : " << similarity << ")\n" << endl;
+            LOG_WARN("[ALERT] " << vehicle_id << " 차량이 " << human_id << " 인간을 향해 측면에서 접근 중입니다. "
+                     << board_id << " dot matrix를 가동합니다. (코사인 유사도 : " << similarity << ")");
             
-            // 7. 보드 제어
-            control_board(board_id, 0x01); // 0x01 명령어   
-            sleep(5);
-            control_board(board_id, 0x02); // 0x02 명령어
+            // 7. 보드 제어 (LCD-on 은 바로, LCD-off 는 ALERT_HOLD 뒤 스케줄러가 보냄, 켜져 있으면 연장)
+            alert_scheduler->trigger(board_id, ALERT_HOLD);
 
-            // 화면 캡처 및 DB 저장
-            capture_screen_and_save(db, utc_time_str);
+            // 화면 캡처 및 DB 저장 (캡처 스레드에 시각만 넘기고 바로 반환)
+            screen_capturer->submit(utc_time_str);
         } else {
-            cout << "[DEBUG] Step Failed (Vehicle " << vehicle_id << "): Cosine similarity not high enough." << endl;
+            LOG_DEBUG("Step Failed (Vehicle " << vehicle_id << "): Cosine similarity not high enough.");
         }
     }
 }
@@ -550,128 +523,113 @@ float compute_cosine_similarity(const Point& a, const Point& b) {
 }
 
 
-// ffmpeg 메타데이터 처리 루프
-void metadata_thread(SQLite::Database& db) {
-    cout << "[INFO] FFmpeg 메타데이터 스트림을 시작합니다..." << endl;
-
-    const string cmd = "ffmpeg -i " + RTSP_URL + " -map 0:1 -f data - 2>/dev/null";
-
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe) {
-        cerr << "[ERROR] Failed to open ffmpeg pipe" << endl;
-        return;
-    }
+// 메타데이터 처리 루프 (RTSP 메타데이터 트랙을 직접 받아 문서가 완성될 때마다 처리)
+void metadata_thread(DbHandle& db) {
+    // 테스트 시 metadata_replay 등 다른 주소로 바꿀 수 있음
+    const char* url_env = getenv("METADATA_RTSP_URL");
+    const string url = url_env ? url_env : RTSP_URL;
+    LOG_INFO("RTSP 메타데이터 스트림을 시작합니다... (" << url << ")");
 
-    constexpr int BUFFER_SIZE = 8192;
-    char buffer[BUFFER_SIZE];
-    string xml_buffer;
+    FrameCache frame_cache(FRAME_CACHE_SIZE + 1); // 최근 FRAME_CACHE_SIZE 개 + 현재 프레임
+    OnvifDocument doc;                      // 문서마다 재사용 (xml 을 가리키는 string_view)
 
-    deque<string> frame_cache;
+    auto last_check = chrono::steady_clock::now();
+    const auto interval = chrono::seconds(1);
 
-    auto last_reload = chrono::steady_clock::now();
-    const auto interval = chrono::seconds(30);
+    // 수신 스레드(GStreamer 스트리밍 스레드 또는 이 스레드)에서 문서 하나마다 호출 (xml 은 콜백 안에서만 유효)
+    MetadataSource source(url, [&](string_view xml, uint32_t rtp_timestamp) {
+        lock_guard<recursive_mutex> lock(data_mutex);
 
-    while (fgets(buffer, BUFFER_SIZE, pipe)) {
-        xml_buffer += buffer;
-
-        // 일정 시간마다 DB 설정값 Reload
+        // 일정 시간마다 DB 설정값이 바뀌었는지 확인하고, 바뀌었을 때만 Reload
         auto now = chrono::steady_clock::now();
-        if (now - last_reload > interval) {
-            {
-                lock_guard<recursive_mutex> lock(data_mutex);
+        if (now - last_check > interval) {
+            if (config_changed(db)) {
                 load_dots_and_center(db);
                 load_rule_lines(db);
-                cout << "[INFO] DB 설정값을 재로딩했습니다." << endl;
+                LOG_INFO("DB 설정값을 재로딩했습니다.");
             }
-            last_reload = now;
+            last_check = now;
+        }
+
+        // 문서를 한 번만 훑어 Frame 과 LineCrossing 이벤트를 추출
+        parse_metadata_stream(xml, doc);
+
+        // Frame block 처리 (파싱한 값만 캐시에 복사하므로 이후 조회에서 다시 파싱하지 않음)
+        if (doc.has_frame) {
+            frame_cache.push(doc.frame);
+            update_vehicle_positions(doc.frame, frame_cache);
         }
 
-        // XML 블럭 완성 여부 확인
-        if (xml_buffer.find("</tt:MetadataStream>") != string::npos) {
-            string block = xml_buffer;
-            xml_buffer.clear();
-
-            {
-                lock_guard<recursive_mutex> lock(data_mutex);
-
-                // Frame block 처리
-                if (contains_frame_block(block)) {
-                    frame_cache.push_back(block);
-                    if (frame_cache.size() > FRAME_CACHE_SIZE) {
-                        frame_cache.pop_front();
-                    }
-                    update_vehicle_positions(block, frame_cache);
-                }
-
-                // Event block 처리
-                string object_id, rule_name;
-                if (is_linecrossing_event(block, object_id, rule_name)) {
-                    bool human_found = false;
-                    string utc_time_str; // 프레임의 UTC 시간을 저장할 변수
-
-                    for (auto it = frame_cache.rbegin(); it != frame_cache.rend(); ++it) {
-                        if (is_human(*it, object_id)) {
-                            human_found = true;
-                            
-                            // Human이 발견된 프레임에서 UTC 시간 추출
-                            regex utc_regex("<tt:Frame[^>]*UtcTime=\"([^\"]+)\"[^>]*>");
-                            smatch utc_match;
-                            if (regex_search(*it, utc_match, utc_regex) && utc_match.size() > 1) {
-                                utc_time_str = utc_match[1].str();
-                            }
-                            break;
-                        }
-                    }
-
-                    if (human_found) {
-                        //cout << "[DEBUG] Human " << object_id << " crossed a line. Triggering analysis." << endl;
-                        // 분석 함수에 DB 객체와 UTC 시간 전달
-                        analyze_risk_and_alert(db, stoi(object_id), rule_name, utc_time_str);
-                    } else {
-                        //cout << "[DEBUG] A line was crossed by object " << object_id << ", but it was not identified as a human in recent frames." << endl;
-                    }
-                }
+        // Event block 처리
+        for (const auto& event : doc.line_crossings) {
+            LOG_DEBUG("LineCrossing Event: ObjectId=" << event.object_id << ", RuleName=" << event.rule_name << " (RTP " << rtp_timestamp << ")");
+
+            string utc_time_str; // Human 이 발견된 프레임의 UTC 시간
+            if (find_human_frame(event.object_id, frame_cache, utc_time_str)) {
+                // 분석 함수에 UTC 시간 전달 (감지 이미지 저장은 DetectionWriter 가 처리)
+                analyze_risk_and_alert(event.object_id, string(event.rule_name), utc_time_str);
+            } else {
+                LOG_DEBUG("A line was crossed by object " << event.object_id << ", but it was not identified as a human in recent frames.");
             }
         }
-    }
+    });
 
-    pclose(pipe);
-    cout << "[INFO] 메타데이터 스트림이 종료되었습니다." << endl;
+    if (!source.run()) {
+        LOG_ERROR("메타데이터 스트림 수신 실패");
+    }
+    LOG_INFO("메타데이터 스트림이 종료되었습니다.");
 }
 
 
 // --- 메인 진입점 ---
 int main() {
-    cout << "[INFO] 메타데이터 모니터링을 시작합니다..." << endl;
+    LOG_INFO("메타데이터 모니터링을 시작합니다...");
     try {
         // DB 파일 열기
-        SQLite::Database db(DB_FILE, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+        DbHandle db(DB_FILE, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+        image_store = make_unique<ImageStore>(IMAGE_STORE_DIR);
+        thumbnail_options = thumbnail_options_from_env();
         
         // DB 테이블 생성 (없으면)
         create_detections_table(db);
 
-        // DB에서 설정값 로드
+        // DB에서 설정값 로드 (현재 설정 버전을 먼저 기록해 두어 로드 중 바뀐 경우도 다음 확인에서 반영)
+        config_changed(db);
         load_dots_and_center(db);
         load_rule_lines(db);
 
         // 설정값 로드 확인
         if (base_line_pairs.empty() || rule_lines.empty()) {
-            cerr << "[FATAL] Failed to load configuration from database. Check 'baseLines' and 'lines' tables." << endl;
+            LOG_ERROR("Failed to load configuration from database. Check 'baseLines' and 'lines' tables.");
             return 1;
         }
 
+        // 감지 이미지 저장 전용 연결/스레드 (테이블이 준비된 뒤 시작)
+        detection_writer = make_unique<DetectionWriter>(DB_FILE, *image_store, thumbnail_options);
+        board_manager = make_unique<BoardManager>(board_info);
+        alert_scheduler = make_unique<AlertScheduler>(control_board);
+        screen_capturer = make_unique<ScreenCapturer>(capture_screen_and_save);
+
         // 메타데이터 처리 스레드 시작 (DB 객체 전달)
         metadata_thread(db);
 
+        // 켜 둔 보드를 끄고 (남은 명령 전송), 남은 캡처와 대기열의 감지 이미지를 모두 저장한 뒤 종료
+        alert_scheduler->stop();
+        board_manager->stop();
+        screen_capturer->stop();
+        detection_writer->stop();
+
     } catch (const std::exception& e) {
-        cerr << "[FATAL] SQLite exception: " << e.what() << endl;
+        LOG_ERROR("SQLite exception: " << e.what());
         return 1;
     }
-    cout << "[INFO] 메타데이터 모니터링을 종료합니다." << endl;
+    LOG_INFO("메타데이터 모니터링을 종료합니다.");
     return 0;
 }
 
 
 /*compile with:
- g++ main_control.cpp board_control.cpp -o control -lSQLiteCpp -lsqlite3 --std=c++17   
+ g++ main_control.cpp board_control.cpp board_manager.cpp ../statement_cache.cpp ../image_store.cpp ../thumbnail.cpp ../detection_writer.cpp ../db_management.cpp ../config_cache.cpp ../logger.cpp onvif_parser.cpp frame_cache.cpp alert_scheduler.cpp screen_capturer.cpp ffmpeg_metadata_source.cpp -o control -lSQLiteCpp -lsqlite3 -lcrypto -ljpeg -pthread --std=c++17   
+ GStreamer 수신으로 빌드:
+ g++ -DMETADATA_GSTREAMER main_control.cpp board_control.cpp board_manager.cpp ../statement_cache.cpp ../image_store.cpp ../thumbnail.cpp ../detection_writer.cpp ../db_management.cpp ../config_cache.cpp ../logger.cpp onvif_parser.cpp frame_cache.cpp alert_scheduler.cpp screen_capturer.cpp metadata_source.cpp -o control $(pkg-config --cflags --libs gstreamer-1.0 gstreamer-app-1.0 gstreamer-rtp-1.0) -lSQLiteCpp -lsqlite3 -lcrypto -ljpeg -pthread --std=c++17   
 */
@@ -0,0 +1,16 @@
+// 메타데이터 수신 모듈 공통 정의 (MetadataSource, FfmpegMetadataSource)
+
+#pragma once
+
+#include <functional>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// 완성된 문서 하나 (수신 스레드에서 호출, xml 은 콜백 안에서만 유효)
+// rtp_timestamp 는 RTP 패킷을 직접 받는 MetadataSource 만 채움 (ffmpeg 로 받으면 0)
+using MetadataCallback = function<void(string_view xml, uint32_t rtp_timestamp)>;
+
+const size_t METADATA_DOCUMENT_MAX_SIZE = 1 << 20;      // 문서 끝이 계속 안 오면 버리는 크기
@@ -0,0 +1,144 @@
+// 녹화한 ONVIF 메타데이터를 RTSP 로 다시 내보내는 테스트용 서버 (카메라 대신 사용)
+// 메타데이터 트랙 하나(application, VND.ONVIF.METADATA)만 있으며, 문서마다 같은 RTP 타임스탬프로 나눠 보내고 마지막 패킷에 marker 를 켠다.
+// 스트림 녹화: ffmpeg -i <RTSP 주소> -map 0:1 -f data - > metadata.xml
+// 사용법: ./metadata_replay metadata.xml [포트 (기본 8555)] [초당 문서 수 (기본 10)]
+// 접속 주소: rtsp://127.0.0.1:<포트>/metadata  (control 실행 시 METADATA_RTSP_URL 로 지정, 파일 끝에 도달하면 처음부터 반복)
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include <gst/gst.h>
+#include <gst/app/gstappsrc.h>
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/rtsp-server/rtsp-server.h>
+
+using namespace std;
+
+const size_t REPLAY_PAYLOAD_SIZE = 1400;    // 패킷 하나의 최대 페이로드 (MTU 이하)
+const guint REPLAY_PAYLOAD_TYPE = 107;
+const guint32 REPLAY_CLOCK_RATE = 90000;
+
+struct Recording {
+    vector<string> documents;
+    int documents_per_sec;
+};
+
+// 클라이언트(미디어)마다 하나
+struct ReplayState {
+    const Recording* recording;
+    size_t next_document = 0;
+    guint16 sequence = 0;
+    guint32 timestamp = 0;
+};
+
+// 문서 하나를 RTP 패킷으로 나눠 appsrc 에 넣음
+static void push_document(GstAppSrc* appsrc, ReplayState& state) {
+    const string& document = state.recording->documents[state.next_document++ % state.recording->documents.size()];
+    for (size_t offset = 0; offset < document.size(); offset += REPLAY_PAYLOAD_SIZE) {
+        size_t length = min(REPLAY_PAYLOAD_SIZE, document.size() - offset);
+        GstBuffer* buffer = gst_rtp_buffer_new_allocate(length, 0, 0);
+
+        GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+        gst_rtp_buffer_map(buffer, GST_MAP_WRITE, &rtp);
+        gst_rtp_buffer_set_payload_type(&rtp, REPLAY_PAYLOAD_TYPE);
+        gst_rtp_buffer_set_seq(&rtp, state.sequence++);
+        gst_rtp_buffer_set_timestamp(&rtp, state.timestamp);
+        gst_rtp_buffer_set_marker(&rtp, offset + length == document.size());
+        memcpy(gst_rtp_buffer_get_payload(&rtp), document.data() + offset, length);
+        gst_rtp_buffer_unmap(&rtp);
+
+        gst_app_src_push_buffer(appsrc, buffer); // buffer 소유권 이전
+    }
+    state.timestamp += REPLAY_CLOCK_RATE / state.recording->documents_per_sec;
+}
+
+// appsrc 가 데이터를 원할 때마다 문서 하나를 보내고 다음 문서 시각까지 대기 (appsrc 스트리밍 스레드)
+static void on_need_data(GstElement* appsrc, guint, gpointer user_data) {
+    auto* state = static_cast<ReplayState*>(user_data);
+    push_document(GST_APP_SRC(appsrc), *state);
+    g_usleep(G_USEC_PER_SEC / state->recording->documents_per_sec);
+}
+
+static void free_state(gpointer data) {
+    delete static_cast<ReplayState*>(data);
+}
+
+static void on_media_configure(GstRTSPMediaFactory*, GstRTSPMedia* media, gpointer user_data) {
+    GstElement* element = gst_rtsp_media_get_element(media);
+    GstElement* appsrc = gst_bin_get_by_name_recurse_up(GST_BIN(element), "pay0");
+
+    auto* state = new ReplayState{static_cast<const Recording*>(user_data)};
+    // 미디어가 사라질 때 상태도 해제
+    g_object_set_data_full(G_OBJECT(media), "replay-state", state, free_state);
+    g_signal_connect(appsrc, "need-data", G_CALLBACK(on_need_data), state);
+
+    gst_object_unref(appsrc);
+    gst_object_unref(element);
+}
+
+int main(int argc, char* argv[]) {
+    gst_init(&argc, &argv);
+    if (argc < 2) {
+        cerr << "사용법: " << argv[0] << " <녹화한 메타데이터 파일> [포트] [초당 문서 수]" << endl;
+        return 1;
+    }
+    string port = argc > 2 ? argv[2] : "8555";
+    Recording recording;
+    recording.documents_per_sec = max(1, argc > 3 ? stoi(argv[3]) : 10);
+
+    ifstream file(argv[1], ios::binary);
+    if (!file) {
+        cerr << "파일을 열 수 없습니다: " << argv[1] << endl;
+        return 1;
+    }
+    stringstream contents;
+    contents << file.rdbuf();
+    string stream = contents.str();
+
+    // ffmpeg -f data 출력은 문서가 그대로 이어져 있으므로 종료 태그 기준으로 나눔
+    const string end_tag = "</tt:MetadataStream>";
+    size_t start = 0;
+    for (size_t end; (end = stream.find(end_tag, start)) != string::npos; start = end + end_tag.size()) {
+        size_t begin = stream.find('<', start);
+        recording.documents.push_back(stream.substr(begin, end + end_tag.size() - begin));
+    }
+    if (recording.documents.empty()) {
+        cerr << "MetadataStream 문서가 없습니다: " << argv[1] << endl;
+        return 1;
+    }
+
+    GstRTSPServer* server = gst_rtsp_server_new();
+    gst_rtsp_server_set_service(server, port.c_str());
+    GstRTSPMountPoints* mounts = gst_rtsp_server_get_mount_points(server);
+
+    // 페이로드를 직접 만들므로 payloader 대신 RTP caps 의 appsrc 를 pay0 으로 사용
+    GstRTSPMediaFactory* factory = gst_rtsp_media_factory_new();
+    gst_rtsp_media_factory_set_launch(factory,
+        "( appsrc name=pay0 is-live=true format=time do-timestamp=true "
+        "caps=\"application/x-rtp,media=application,payload=107,clock-rate=90000,encoding-name=VND.ONVIF.METADATA\" )");
+    gst_rtsp_media_factory_set_shared(factory, TRUE);
+    g_signal_connect(factory, "media-configure", G_CALLBACK(on_media_configure), &recording);
+    gst_rtsp_mount_points_add_factory(mounts, "/metadata", factory);
+    g_object_unref(mounts);
+
+    if (gst_rtsp_server_attach(server, NULL) == 0) {
+        cerr << "RTSP 서버 Attach 실패" << endl;
+        return 1;
+    }
+    cout << "문서 " << recording.documents.size() << "개를 초당 " << recording.documents_per_sec
+         << "개씩 반복 송출: rtsp://127.0.0.1:" << port << "/metadata" << endl;
+
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+    g_main_loop_run(loop);
+    g_main_loop_unref(loop);
+    return 0;
+}
+
+/*compile with:
+ g++ metadata_replay.cpp -o metadata_replay $(pkg-config --cflags --libs gstreamer-rtsp-server-1.0 gstreamer-app-1.0 gstreamer-rtp-1.0) --std=c++17
+*/
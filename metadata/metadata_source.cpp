@@ -0,0 +1,183 @@
+#include "metadata_source.hpp"
+#include "../logger.hpp"
+
+#include <exception>
+
+#include <gst/rtp/gstrtpbuffer.h>
+
+MetadataSource::MetadataSource(const string& rtsp_url, MetadataCallback callback) : callback(move(callback)) {
+    // 여러 번 호출해도 안전
+    gst_init(nullptr, nullptr);
+
+    pipeline = gst_pipeline_new("metadata");
+    source = gst_element_factory_make("rtspsrc", "source");
+    sink = gst_element_factory_make("appsink", "sink");
+    if (!pipeline || !source || !sink) {
+        LOG_ERROR("메타데이터 파이프라인 생성 실패 (rtspsrc, appsink 플러그인 확인)");
+        if (source) gst_object_unref(source);
+        if (sink) gst_object_unref(sink);
+        if (pipeline) gst_object_unref(pipeline);
+        pipeline = source = sink = nullptr;
+        return;
+    }
+
+    g_object_set(source, "location", rtsp_url.c_str(), "latency", METADATA_RTSP_LATENCY_MS, NULL);
+
+    // 페이로드는 직접 이어 붙이므로 depayloader 없이 RTP 패킷을 그대로 받음 (sync=false: 도착 즉시 전달)
+    GstCaps* caps = gst_caps_new_simple("application/x-rtp", "media", G_TYPE_STRING, "application", NULL);
+    g_object_set(sink, "caps", caps, "sync", FALSE, NULL);
+    gst_caps_unref(caps);
+
+    GstAppSinkCallbacks callbacks = {};
+    callbacks.new_sample = &MetadataSource::on_new_sample;
+    gst_app_sink_set_callbacks(GST_APP_SINK(sink), &callbacks, this, nullptr);
+
+    gst_bin_add_many(GST_BIN(pipeline), source, sink, NULL);
+    g_signal_connect(source, "select-stream", G_CALLBACK(&MetadataSource::on_select_stream), this);
+    g_signal_connect(source, "pad-added", G_CALLBACK(&MetadataSource::on_pad_added), this);
+}
+
+MetadataSource::~MetadataSource() {
+    if (pipeline) {
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(pipeline);
+    }
+}
+
+bool MetadataSource::run() {
+    if (!pipeline) return false;
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        LOG_ERROR("메타데이터 파이프라인 시작 실패");
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        return false;
+    }
+
+    bool ok = true;
+    bool done = false;
+    GstBus* bus = gst_element_get_bus(pipeline);
+    GstMessageType types = static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR | GST_MESSAGE_WARNING | GST_MESSAGE_APPLICATION);
+    while (!done) {
+        GstMessage* message = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE, types);
+        if (!message) break;
+
+        switch (GST_MESSAGE_TYPE(message)) {
+            case GST_MESSAGE_ERROR: {
+                GError* error = nullptr;
+                gchar* debug = nullptr;
+                gst_message_parse_error(message, &error, &debug);
+                LOG_ERROR("메타데이터 스트림 오류: " << error->message << (debug ? " (" : "") << (debug ? debug : "") << (debug ? ")" : ""));
+                g_clear_error(&error);
+                g_free(debug);
+                ok = false;
+                done = true;
+                break;
+            }
+            case GST_MESSAGE_WARNING: {
+                GError* error = nullptr;
+                gst_message_parse_warning(message, &error, nullptr);
+                LOG_WARN("메타데이터 스트림 경고: " << error->message);
+                g_clear_error(&error);
+                break;
+            }
+            default: // EOS, stop()
+                done = true;
+                break;
+        }
+        gst_message_unref(message);
+    }
+    gst_object_unref(bus);
+
+    // 스트리밍 스레드가 멈춘 뒤 (marker 를 받지 못한 마지막 조각은 버림)
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    document.clear();
+    return ok;
+}
+
+void MetadataSource::stop() {
+    if (!pipeline) return;
+    GstBus* bus = gst_element_get_bus(pipeline);
+    gst_bus_post(bus, gst_message_new_application(GST_OBJECT(pipeline), gst_structure_new_empty("stop")));
+    gst_object_unref(bus);
+}
+
+// 메타데이터 트랙만 SETUP (영상/음성 트랙은 받지 않음)
+gboolean MetadataSource::on_select_stream(GstElement*, guint num, GstCaps* caps, gpointer) {
+    const GstStructure* structure = gst_caps_get_structure(caps, 0);
+    const gchar* media = gst_structure_get_string(structure, "media");
+    const gchar* encoding = gst_structure_get_string(structure, "encoding-name");
+    bool selected = g_strcmp0(media, "application") == 0 && encoding != nullptr && g_ascii_strcasecmp(encoding, "VND.ONVIF.METADATA") == 0;
+    LOG_DEBUG("RTSP 트랙 " << num << ": " << (media ? media : "?") << " / " << (encoding ? encoding : "?") << (selected ? " (수신)" : " (무시)"));
+    return selected ? TRUE : FALSE;
+}
+
+void MetadataSource::on_pad_added(GstElement*, GstPad* pad, gpointer user_data) {
+    auto* self = static_cast<MetadataSource*>(user_data);
+    GstPad* sink_pad = gst_element_get_static_pad(self->sink, "sink");
+    if (!gst_pad_is_linked(sink_pad) && gst_pad_link(pad, sink_pad) != GST_PAD_LINK_OK) {
+        LOG_ERROR("메타데이터 트랙을 appsink 에 연결하지 못했습니다.");
+    }
+    gst_object_unref(sink_pad);
+}
+
+GstFlowReturn MetadataSource::on_new_sample(GstAppSink* sink, gpointer user_data) {
+    auto* self = static_cast<MetadataSource*>(user_data);
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_EOS;
+    self->handle_packet(gst_sample_get_buffer(sample));
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+void MetadataSource::handle_packet(GstBuffer* buffer) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    if (!gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp)) return;
+
+    uint16_t sequence = gst_rtp_buffer_get_seq(&rtp);
+    uint32_t timestamp = gst_rtp_buffer_get_timestamp(&rtp);
+    bool marker = gst_rtp_buffer_get_marker(&rtp);
+
+    // 패킷 유실: 조립 중인 문서와 이 패킷의 문서는 깨졌으므로 이 문서가 끝날 때까지 버림
+    if (has_sequence && sequence != next_sequence) {
+        LOG_WARN("메타데이터 RTP 패킷 유실 (seq " << next_sequence << " 대신 " << sequence << "), 문서를 버립니다.");
+        document.clear();
+        skipping = true;
+        document_timestamp = timestamp;
+    } else if (timestamp != document_timestamp) {
+        // 타임스탬프가 바뀌면 새 문서 시작 (marker 를 켜지 않는 카메라는 이때 이전 문서가 끝난 것으로 봄)
+        // 버리던 문서도 여기서 끝나므로 marker 가 오지 않아도 다음 문서부터 다시 받음
+        if (!skipping) deliver_document();
+        document.clear();
+        skipping = false;
+        document_timestamp = timestamp;
+    }
+    has_sequence = true;
+    next_sequence = sequence + 1;
+
+    if (!skipping) {
+        document.append(static_cast<const char*>(gst_rtp_buffer_get_payload(&rtp)), gst_rtp_buffer_get_payload_len(&rtp));
+        if (document.size() > METADATA_DOCUMENT_MAX_SIZE) {
+            LOG_WARN("메타데이터 문서가 " << METADATA_DOCUMENT_MAX_SIZE << " 바이트를 넘어 버립니다.");
+            document.clear();
+            skipping = true;
+        }
+    }
+    gst_rtp_buffer_unmap(&rtp);
+
+    if (marker) {
+        if (!skipping) deliver_document();
+        document.clear();
+        skipping = false;
+    }
+}
+
+void MetadataSource::deliver_document() {
+    if (document.empty()) return;
+    try {
+        callback(document, document_timestamp);
+    } catch (const exception& e) {
+        // GStreamer 스레드(C 코드)로 예외가 넘어가지 않도록 여기서 처리
+        LOG_ERROR("메타데이터 문서 처리 실패: " << e.what());
+    }
+    document.clear();
+}
@@ -0,0 +1,54 @@
+// ONVIF 메타데이터 수신 모듈 (GStreamer)
+// rtspsrc 로 카메라 RTSP 에 직접 붙어 메타데이터 트랙(application, VND.ONVIF.METADATA)만 SETUP 하고,
+// appsink 로 받은 RTP 패킷의 페이로드를 이어 붙여 MetadataStream 문서 하나가 완성될 때마다 콜백으로 넘긴다.
+// ONVIF Streaming 규격에 따라 한 문서의 패킷은 같은 RTP 타임스탬프를 쓰고, 마지막 패킷에 marker 비트가 켜진다.
+// 별도 ffmpeg 프로세스와 파이프, 줄 단위 버퍼링 없이 패킷이 도착하는 즉시 문서를 처리할 수 있다.
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+
+#include "metadata_document.hpp"
+
+using namespace std;
+
+const guint METADATA_RTSP_LATENCY_MS = 100;             // rtspsrc 지터 버퍼 (기본 2초는 경보가 늦어짐)
+
+class MetadataSource {
+public:
+    MetadataSource(const string& rtsp_url, MetadataCallback callback);
+    ~MetadataSource();
+
+    MetadataSource(const MetadataSource&) = delete;
+    MetadataSource& operator=(const MetadataSource&) = delete;
+
+    // 스트림이 끝나거나(EOS), 오류가 나거나, stop() 이 호출될 때까지 대기. 파이프라인을 만들지 못했거나 오류면 false
+    bool run();
+    // 다른 스레드에서 run() 을 끝냄
+    void stop();
+
+private:
+    static gboolean on_select_stream(GstElement* source, guint num, GstCaps* caps, gpointer user_data);
+    static void on_pad_added(GstElement* source, GstPad* pad, gpointer user_data);
+    static GstFlowReturn on_new_sample(GstAppSink* sink, gpointer user_data);
+
+    // RTP 패킷 하나를 문서에 이어 붙이고, 문서가 완성되면 콜백 호출
+    void handle_packet(GstBuffer* buffer);
+    void deliver_document();
+
+    MetadataCallback callback;
+    GstElement* pipeline = nullptr;
+    GstElement* source = nullptr;
+    GstElement* sink = nullptr;
+
+    // 스트리밍 스레드 전용 조립 상태
+    string document;
+    uint32_t document_timestamp = 0;
+    bool has_sequence = false;
+    uint16_t next_sequence = 0;
+    bool skipping = false;                  // 패킷 유실/크기 초과로 깨진 문서는 marker 나 타임스탬프가 바뀔 때까지 버림
+};
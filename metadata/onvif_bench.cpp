@@ -0,0 +1,169 @@
+// ONVIF 메타데이터 파서 벤치마크
+// 녹화한 메타데이터 스트림으로 기존 정규식 방식과 onvif_parser 의 처리량을 비교하고, 두 방식의 추출 결과가 같은지 확인
+// 스트림 녹화: ffmpeg -i <RTSP 주소> -map 0:1 -f data - > metadata.xml  (원하는 만큼 받은 뒤 Ctrl+C)
+// 사용법: ./onvif_bench metadata.xml [반복 횟수 (기본 20)]
+
+#include "onvif_parser.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 두 방식이 같은 값을 뽑았는지 비교하기 위한 요약
+struct Extracted {
+    size_t frames = 0;
+    size_t vehicles = 0;            // 타입이 Vehicle 이고 CenterOfGravity 가 있는 객체
+    long long vehicle_id_sum = 0;
+    double center_sum = 0;
+    size_t line_crossings = 0;
+    long long crossing_id_sum = 0;
+    size_t rule_name_bytes = 0;
+    size_t humans = 0;              // 이벤트 객체가 같은 문서에서 Human 으로 표시된 경우
+
+    bool operator==(const Extracted& other) const {
+        return frames == other.frames && vehicles == other.vehicles && vehicle_id_sum == other.vehicle_id_sum &&
+               abs(center_sum - other.center_sum) < 1e-3 * max(1.0, abs(center_sum)) &&
+               line_crossings == other.line_crossings && crossing_id_sum == other.crossing_id_sum &&
+               rule_name_bytes == other.rule_name_bytes && humans == other.humans;
+    }
+};
+
+// 기존 main_control.cpp 의 정규식 방식 (호출마다 regex 생성)
+void extract_with_regex(const string& block, Extracted& result) {
+    if (block.find("<tt:VideoAnalytics>") != string::npos && block.find("<tt:Frame") != string::npos) {
+        result.frames++;
+        regex object_block_regex("<tt:Object ObjectId=\"(\\d+)\">([\\s\\S]*?)</tt:Object>");
+        for (auto it = sregex_iterator(block.begin(), block.end(), object_block_regex); it != sregex_iterator(); ++it) {
+            int id = stoi((*it)[1]);
+            string object_content = (*it)[2].str();
+
+            smatch type_match;
+            if (!regex_search(object_content, type_match, regex("<tt:Type[^>]*>([^<]*)</tt:Type>"))) continue;
+            string type = type_match[1];
+            if (type != "Vehicle" && type != "Vehical") continue;
+
+            smatch cog_match;
+            if (!regex_search(object_content, cog_match, regex("<tt:CenterOfGravity[^>]*x=\"([\\d.]+)\" y=\"([\\d.]+)\""))) continue;
+            result.vehicles++;
+            result.vehicle_id_sum += id;
+            result.center_sum += stof(cog_match[1]) + stof(cog_match[2]);
+        }
+    }
+
+    regex topic_regex("<wsnt:Topic[^>]*>([^<]*)</wsnt:Topic>");
+    smatch topic_match;
+    if (!regex_search(block, topic_match, topic_regex) || string(topic_match[1]).find("LineCrossing") == string::npos) return;
+
+    regex id_regex("<tt:SimpleItem Name=\"ObjectId\" Value=\"(\\d+)\"/>");
+    regex rule_regex("<tt:SimpleItem Name=\"RuleName\" Value=\"([^\"]+)\"/>");
+    regex state_regex("<tt:SimpleItem Name=\"State\" Value=\"true\"");
+    smatch match;
+    string object_id, rule_name;
+    bool id_ok = regex_search(block, match, id_regex);
+    if (id_ok) object_id = match[1];
+    bool rule_ok = regex_search(block, match, rule_regex);
+    if (rule_ok) rule_name = match[1];
+    if (!id_ok || !rule_ok || !regex_search(block, match, state_regex)) return;
+
+    result.line_crossings++;
+    result.crossing_id_sum += stoi(object_id);
+    result.rule_name_bytes += rule_name.size();
+
+    regex human_regex("<tt:Object ObjectId=\"" + object_id + "\"[\\s\\S]*?<tt:Type[^>]*>([^<]*)</tt:Type>");
+    if (regex_search(block, match, human_regex) && match[1] == "Human") result.humans++;
+}
+
+void extract_with_parser(const string& block, OnvifDocument& doc, Extracted& result) {
+    parse_metadata_stream(block, doc);
+    if (doc.has_frame) {
+        result.frames++;
+        for (const auto& object : doc.frame.objects) {
+            if (object.type != "Vehicle" && object.type != "Vehical") continue;
+            if (!object.has_center) continue;
+            result.vehicles++;
+            result.vehicle_id_sum += object.id;
+            result.center_sum += object.center_x + object.center_y;
+        }
+    }
+    for (const auto& event : doc.line_crossings) {
+        result.line_crossings++;
+        result.crossing_id_sum += event.object_id;
+        result.rule_name_bytes += event.rule_name.size();
+        const OnvifObject* object = doc.frame.find_object(event.object_id);
+        if (object != nullptr && object->type == "Human") result.humans++;
+    }
+}
+
+// 모든 문서를 iterations 번 처리하는 데 걸린 시간으로 MB/s 계산
+template <typename Extract>
+double measure_mb_per_sec(const vector<string>& blocks, int iterations, Extract extract, Extracted& result) {
+    size_t total_bytes = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        result = Extracted();
+        for (const auto& block : blocks) {
+            extract(block, result);
+            total_bytes += block.size();
+        }
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return (total_bytes / (1024.0 * 1024.0)) / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "사용법: " << argv[0] << " <녹화한 메타데이터 파일> [반복 횟수]" << endl;
+        return 1;
+    }
+    int iterations = argc > 2 ? stoi(argv[2]) : 20;
+
+    ifstream file(argv[1], ios::binary);
+    if (!file) {
+        cerr << "파일을 열 수 없습니다: " << argv[1] << endl;
+        return 1;
+    }
+    stringstream contents;
+    contents << file.rdbuf();
+    string stream = contents.str();
+
+    // metadata_thread 와 같은 기준으로 문서 단위로 나눔
+    const string end_tag = "</tt:MetadataStream>";
+    vector<string> blocks;
+    size_t start = 0;
+    for (size_t end; (end = stream.find(end_tag, start)) != string::npos; start = end + end_tag.size()) {
+        blocks.push_back(stream.substr(start, end + end_tag.size() - start));
+    }
+    if (blocks.empty()) {
+        cerr << "MetadataStream 문서가 없습니다: " << argv[1] << endl;
+        return 1;
+    }
+
+    Extracted regex_result, parser_result;
+    double regex_speed = measure_mb_per_sec(blocks, iterations, extract_with_regex, regex_result);
+    OnvifDocument doc;
+    double parser_speed = measure_mb_per_sec(blocks, iterations,
+        [&doc](const string& block, Extracted& result) { extract_with_parser(block, doc, result); }, parser_result);
+
+    cout << "문서 " << blocks.size() << "개 (" << stream.size() / 1024 << " KB), 프레임 " << parser_result.frames
+         << ", 차량 " << parser_result.vehicles << ", LineCrossing " << parser_result.line_crossings << ", 반복 " << iterations << "회" << endl;
+    cout << fixed << setprecision(1);
+    cout << "regex  : " << setw(8) << regex_speed << " MB/s" << endl;
+    cout << "parser : " << setw(8) << parser_speed << " MB/s (x" << setprecision(1) << parser_speed / regex_speed << ")" << endl;
+    if (!(regex_result == parser_result)) {
+        cerr << "추출 결과 불일치 (regex 차량 " << regex_result.vehicles << ", 이벤트 " << regex_result.line_crossings
+             << " / parser 차량 " << parser_result.vehicles << ", 이벤트 " << parser_result.line_crossings << ")" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*compile with:
+ g++ -O2 onvif_bench.cpp onvif_parser.cpp -o onvif_bench --std=c++17
+*/
@@ -0,0 +1,207 @@
+#include "onvif_parser.hpp"
+
+#include <charconv>
+
+namespace {
+
+// 태그 하나 (문자열은 모두 입력 XML 을 가리킴)
+struct XmlTag {
+    string_view name;           // 네임스페이스 접두사를 뗀 이름 (tt:Object -> Object)
+    string_view attributes;     // 이름 뒤부터 '>' 앞까지
+    string_view text;           // 태그 뒤부터 다음 '<' 앞까지
+    bool closing = false;       // </...>
+    bool self_closing = false;  // <.../>
+};
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+string_view trim(string_view s) {
+    while (!s.empty() && is_space(s.front())) s.remove_prefix(1);
+    while (!s.empty() && is_space(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+string_view local_name(string_view name) {
+    size_t colon = name.find(':');
+    return colon == string_view::npos ? name : name.substr(colon + 1);
+}
+
+// 앞으로만 진행하며 태그를 하나씩 꺼내는 토크나이저 (선언, 주석, CDATA 는 건너뜀)
+class XmlTokenizer {
+public:
+    explicit XmlTokenizer(string_view xml) : xml(xml) {}
+
+    bool next(XmlTag& tag) {
+        while (true) {
+            size_t open = xml.find('<', pos);
+            if (open == string_view::npos || open + 1 >= xml.size()) return false;
+
+            char first = xml[open + 1];
+            if (first == '?' || first == '!') {
+                size_t end;
+                if (xml.compare(open, 4, "<!--") == 0) {
+                    end = xml.find("-->", open + 4);
+                    if (end != string_view::npos) end += 2;
+                } else if (xml.compare(open, 9, "<![CDATA[") == 0) {
+                    end = xml.find("]]>", open + 9);
+                    if (end != string_view::npos) end += 2;
+                } else {
+                    end = xml.find('>', open);
+                }
+                if (end == string_view::npos) return false;
+                pos = end + 1;
+                continue;
+            }
+
+            size_t close = xml.find('>', open);
+            if (close == string_view::npos) return false; // 잘린 문서
+
+            string_view inner = xml.substr(open + 1, close - open - 1);
+            tag.closing = !inner.empty() && inner.front() == '/';
+            if (tag.closing) inner.remove_prefix(1);
+            tag.self_closing = !inner.empty() && inner.back() == '/';
+            if (tag.self_closing) inner.remove_suffix(1);
+
+            size_t name_end = 0;
+            while (name_end < inner.size() && !is_space(inner[name_end])) name_end++;
+            tag.name = local_name(inner.substr(0, name_end));
+            tag.attributes = inner.substr(name_end);
+
+            pos = close + 1;
+            size_t text_end = xml.find('<', pos);
+            tag.text = xml.substr(pos, (text_end == string_view::npos ? xml.size() : text_end) - pos);
+            return true;
+        }
+    }
+
+private:
+    string_view xml;
+    size_t pos = 0;
+};
+
+// 속성 값 (없으면 빈 값, 엔티티는 풀지 않음)
+string_view attribute(string_view attributes, string_view name) {
+    size_t i = 0;
+    while (i < attributes.size()) {
+        while (i < attributes.size() && is_space(attributes[i])) i++;
+        size_t name_start = i;
+        while (i < attributes.size() && attributes[i] != '=' && !is_space(attributes[i])) i++;
+        string_view attribute_name = attributes.substr(name_start, i - name_start);
+
+        while (i < attributes.size() && attributes[i] != '"' && attributes[i] != '\'') i++;
+        if (i >= attributes.size()) break;
+        char quote = attributes[i++];
+        size_t value_end = attributes.find(quote, i);
+        if (value_end == string_view::npos) break;
+
+        if (attribute_name == name) return attributes.substr(i, value_end - i);
+        i = value_end + 1;
+    }
+    return {};
+}
+
+bool parse_number(string_view text, int& value) {
+    auto [end, error] = from_chars(text.data(), text.data() + text.size(), value);
+    return error == errc() && end == text.data() + text.size();
+}
+
+bool parse_number(string_view text, float& value) {
+    auto [end, error] = from_chars(text.data(), text.data() + text.size(), value);
+    return error == errc() && end == text.data() + text.size();
+}
+
+} // namespace
+
+const OnvifObject* OnvifFrame::find_object(int id) const {
+    for (const auto& object : objects) {
+        if (object.id == id) return &object;
+    }
+    return nullptr;
+}
+
+void OnvifDocument::clear() {
+    has_frame = false;
+    frame.utc_time = {};
+    frame.objects.clear();
+    line_crossings.clear();
+}
+
+bool parse_metadata_stream(string_view xml, OnvifDocument& doc) {
+    doc.clear();
+
+    bool in_video_analytics = false;
+    bool in_frame = false;
+    OnvifObject* object = nullptr;          // 지금 읽고 있는 tt:Object (objects 의 마지막 원소)
+
+    bool in_notification = false;
+    bool topic_is_line_crossing = false;
+    bool state = false;
+    OnvifLineCrossing event;
+
+    XmlTokenizer tokenizer(xml);
+    XmlTag tag;
+    while (tokenizer.next(tag)) {
+        const string_view name = tag.name;
+
+        if (tag.closing) {
+            if (name == "Object") {
+                object = nullptr;
+            } else if (name == "Frame") {
+                in_frame = false;
+                object = nullptr;
+            } else if (name == "VideoAnalytics") {
+                in_video_analytics = false;
+            } else if (name == "NotificationMessage" && in_notification) {
+                if (topic_is_line_crossing && state && event.object_id >= 0 && !event.rule_name.empty()) {
+                    doc.line_crossings.push_back(event);
+                }
+                in_notification = false;
+            }
+            continue;
+        }
+
+        if (name == "VideoAnalytics") {
+            in_video_analytics = !tag.self_closing;
+        } else if (name == "Frame" && in_video_analytics) {
+            doc.has_frame = true;
+            if (doc.frame.utc_time.empty()) doc.frame.utc_time = attribute(tag.attributes, "UtcTime");
+            in_frame = !tag.self_closing;
+        } else if (name == "Object" && in_frame) {
+            int id;
+            if (!parse_number(attribute(tag.attributes, "ObjectId"), id)) {
+                object = nullptr;
+                continue;
+            }
+            doc.frame.objects.emplace_back();
+            object = &doc.frame.objects.back();
+            object->id = id;
+            if (tag.self_closing) object = nullptr;
+        } else if (name == "Type" && object != nullptr) {
+            if (object->type.empty()) object->type = trim(tag.text);
+        } else if (name == "CenterOfGravity" && object != nullptr) {
+            object->has_center = parse_number(attribute(tag.attributes, "x"), object->center_x) &&
+                                 parse_number(attribute(tag.attributes, "y"), object->center_y);
+        } else if (name == "NotificationMessage") {
+            in_notification = !tag.self_closing;
+            topic_is_line_crossing = false;
+            state = false;
+            event = OnvifLineCrossing();
+        } else if (name == "Topic" && in_notification) {
+            topic_is_line_crossing = trim(tag.text).find("LineCrossing") != string_view::npos;
+        } else if (name == "SimpleItem" && in_notification) {
+            string_view item = attribute(tag.attributes, "Name");
+            string_view value = attribute(tag.attributes, "Value");
+            if (item == "ObjectId") {
+                if (!parse_number(value, event.object_id)) event.object_id = -1;
+            } else if (item == "RuleName") {
+                event.rule_name = value;
+            } else if (item == "State") {
+                state = value == "true";
+            }
+        }
+    }
+
+    return doc.has_frame || !doc.line_crossings.empty();
+}
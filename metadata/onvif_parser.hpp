@@ -0,0 +1,50 @@
+// ONVIF 메타데이터(tt:MetadataStream) 파서
+// 카메라가 보내는 XML 문서 하나를 처음부터 끝까지 한 번만 훑으면서 필요한 요소만 골라낸다.
+//  - tt:Frame (UtcTime), tt:Object (ObjectId), tt:Type, tt:CenterOfGravity
+//  - wsnt:NotificationMessage 안의 wsnt:Topic, tt:SimpleItem (LineCrossing 이벤트)
+// 결과의 문자열은 모두 입력 XML 을 가리키는 string_view 이므로 입력 문자열이 살아 있는 동안만 유효하다.
+// 요소마다 할당하지 않으며, OnvifDocument 를 재사용하면 objects/line_crossings 의 용량도 재사용된다.
+// 일반 XML 파서가 아니라 카메라 출력 형식에 맞춘 토크나이저 (네임스페이스 접두사는 무시하고 이름만 비교)
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// 프레임 안의 객체 하나
+struct OnvifObject {
+    int id = -1;
+    string_view type;           // 첫 번째 tt:Type 내용 (Human, Vehicle ...), 없으면 빈 값
+    bool has_center = false;
+    float center_x = 0;         // tt:CenterOfGravity x, y
+    float center_y = 0;
+};
+
+// tt:VideoAnalytics 안의 tt:Frame
+struct OnvifFrame {
+    string_view utc_time;       // UtcTime 속성 (예: 2025-08-01T01:02:03.456Z)
+    vector<OnvifObject> objects;
+
+    // 없으면 nullptr
+    const OnvifObject* find_object(int id) const;
+};
+
+// State=true 인 LineCrossing 이벤트
+struct OnvifLineCrossing {
+    int object_id = -1;
+    string_view rule_name;
+};
+
+// MetadataStream 문서 하나의 파싱 결과
+struct OnvifDocument {
+    bool has_frame = false;
+    OnvifFrame frame;
+    vector<OnvifLineCrossing> line_crossings;
+
+    void clear();
+};
+
+// xml 을 파싱해 doc 에 채움 (doc 는 먼저 비움), Frame 이나 LineCrossing 이벤트가 하나라도 있으면 true
+bool parse_metadata_stream(string_view xml, OnvifDocument& doc);
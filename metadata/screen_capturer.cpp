@@ -0,0 +1,59 @@
+#include "screen_capturer.hpp"
+#include "../logger.hpp"
+
+#include <algorithm>
+
+ScreenCapturer::ScreenCapturer(Capture capture, size_t queue_size)
+    : capture(move(capture)), queue_size(max<size_t>(queue_size, 1)) {
+    capture_thread = thread(&ScreenCapturer::run, this);
+}
+
+ScreenCapturer::~ScreenCapturer() {
+    stop();
+}
+
+bool ScreenCapturer::submit(const string& utc_time_str) {
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        if (stopping) return false;
+
+        // 한 프레임에서 여러 차량이 경고를 내면 같은 시각이 연달아 들어옴 (캡처는 한 번이면 됨)
+        if (!requests.empty() && requests.back() == utc_time_str) return true;
+        if (requests.size() >= queue_size) {
+            LOG_WARN("Screen capture queue is full. Dropping capture for " << utc_time_str);
+            return false;
+        }
+        requests.push_back(utc_time_str);
+    }
+    queue_not_empty.notify_one();
+    return true;
+}
+
+void ScreenCapturer::stop() {
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_not_empty.notify_all();
+    if (capture_thread.joinable()) capture_thread.join();
+}
+
+void ScreenCapturer::run() {
+    unique_lock<mutex> lock(queue_mutex);
+    while (true) {
+        queue_not_empty.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (requests.empty()) return;
+
+        string utc_time_str = move(requests.front());
+        requests.pop_front();
+
+        // 캡처는 잠금 밖에서 실행 (ffmpeg 가 도는 동안에도 submit 은 바로 반환)
+        lock.unlock();
+        try {
+            capture(utc_time_str);
+        } catch (const exception& e) {
+            LOG_ERROR("Screen capture failed: " << e.what());
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,49 @@
+// 경고 화면 캡처 작업 스레드
+// 경고가 나면 메타데이터 처리 스레드는 UTC 시각만 대기열에 넣고 바로 돌아가며,
+// ffmpeg 로 화면을 캡처해 저장하는 일(수 초 걸림)은 전용 스레드가 하나씩 처리한다. (data_mutex 나 GStreamer 스트리밍 스레드를 붙잡지 않음)
+// 대기열이 가득 차 있으면 기다리지 않고 그 캡처를 버림
+
+#pragma once
+
+#include <string>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// 밀려 있을 수 있는 캡처 요청 최대 수
+const size_t SCREEN_CAPTURE_QUEUE_SIZE = 8;
+
+class ScreenCapturer {
+public:
+    // 캡처 하나를 처리하는 함수 (캡처 스레드에서 호출)
+    using Capture = function<void(const string& utc_time_str)>;
+
+    ScreenCapturer(Capture capture, size_t queue_size = SCREEN_CAPTURE_QUEUE_SIZE);
+    // 대기열에 남은 캡처를 모두 처리한 뒤 종료
+    ~ScreenCapturer();
+
+    ScreenCapturer(const ScreenCapturer&) = delete;
+    ScreenCapturer& operator=(const ScreenCapturer&) = delete;
+
+    // 캡처 요청을 대기열에 넣고 바로 반환 (같은 시각이 이미 대기 중이면 합치고, 가득 찼거나 종료 중이면 false)
+    bool submit(const string& utc_time_str);
+
+    // 새 요청을 받지 않고 남은 캡처를 처리한 뒤 스레드 종료 (여러 번 호출해도 됨)
+    void stop();
+
+private:
+    void run();
+
+    const Capture capture;
+    const size_t queue_size;
+
+    mutex queue_mutex;
+    condition_variable queue_not_empty;
+    deque<string> requests;
+    bool stopping = false;
+    thread capture_thread;
+};
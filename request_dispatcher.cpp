@@ -0,0 +1,236 @@
+#include "request_dispatcher.hpp"
+#include "tcp_server.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// 연결을 빌리면서 대기 시간을 측정
+static DbConnection acquire_timed(RequestContext& ctx, DbLease::Access access) {
+    auto start = chrono::steady_clock::now();
+    DbConnection connection = access == DbLease::WRITE ? ctx.db_pool.acquire_writer() : ctx.db_pool.acquire_reader();
+    ctx.db_lock_wait += chrono::steady_clock::now() - start;
+    return connection;
+}
+
+DbLease::DbLease(RequestContext& ctx, Access access) : connection(acquire_timed(ctx, access)) {}
+
+json make_response(int request_id, const json& correlation_id) {
+    json root;
+    root["request_id"] = request_id;
+    if (!correlation_id.is_null()) root["correlation_id"] = correlation_id;
+    return root;
+}
+
+// has_correlation_id 용 JSON 훑기 (값을 만들지 않고 위치만 옮김, 범위를 넘으면 nullptr)
+static const char* skip_json_space(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    return p;
+}
+
+// p 는 여는 따옴표, 닫는 따옴표 다음 위치를 반환
+static const char* skip_json_string(const char* p, const char* end) {
+    for (p++; p < end; p++) {
+        if (*p == '\\') p++;
+        else if (*p == '"') return p + 1;
+    }
+    return nullptr;
+}
+
+// 값 하나를 건너뛰고 그 뒤 위치를 반환 (문자열, 객체/배열은 짝이 맞는 곳까지, 숫자/true 등은 , 나 } 앞까지)
+static const char* skip_json_value(const char* p, const char* end) {
+    int depth = 0;
+    while (p < end) {
+        char c = *p;
+        if (c == '"') {
+            p = skip_json_string(p, end);
+            if (!p) return nullptr;
+            if (depth == 0) return p;
+        } else if (c == '{' || c == '[') {
+            depth++;
+            p++;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) return p;
+            p++;
+            if (--depth == 0) return p;
+        } else if (c == ',' && depth == 0) {
+            return p;
+        } else {
+            p++;
+        }
+    }
+    return nullptr;
+}
+
+bool has_correlation_id(const vector<char>& frame) {
+    static const string KEY = "correlation_id";
+    const char* p = frame.data();
+    const char* end = p + min(frame.size(), CORRELATION_SCAN_LIMIT);
+
+    p = skip_json_space(p, end);
+    if (p >= end || *p != '{') return false;
+    p++;
+    while (true) {
+        // 키 (이스케이프가 들어간 키는 correlation_id 와 같을 수 없으므로 원문 그대로 비교)
+        p = skip_json_space(p, end);
+        if (p >= end || *p != '"') return false;
+        const char* key = p + 1;
+        p = skip_json_string(p, end);
+        if (!p) return false;
+        bool matched = static_cast<size_t>(p - 1 - key) == KEY.size() && memcmp(key, KEY.data(), KEY.size()) == 0;
+
+        p = skip_json_space(p, end);
+        if (p >= end || *p != ':') return false;
+        p = skip_json_space(p + 1, end);
+        if (p >= end) return false;
+        // null 은 없는 것으로 봄
+        if (matched) return *p != 'n';
+
+        p = skip_json_value(p, end);
+        if (!p) return false;
+        p = skip_json_space(p, end);
+        if (p >= end || *p != ',') return false;
+        p++;
+    }
+}
+
+/*
+
+요청 지표
+
+*/
+
+void RequestStats::record(chrono::nanoseconds latency, chrono::nanoseconds db_lock_wait, size_t bytes, bool failed) {
+    uint64_t latency_us = chrono::duration_cast<chrono::microseconds>(latency).count();
+
+    count++;
+    if (failed) errors++;
+    total_latency_us += latency_us;
+    db_lock_wait_us += chrono::duration_cast<chrono::microseconds>(db_lock_wait).count();
+    response_bytes += bytes;
+
+    uint64_t previous_max = max_latency_us.load();
+    while (latency_us > previous_max && !max_latency_us.compare_exchange_weak(previous_max, latency_us)) {}
+
+    size_t bucket = 0;
+    while (bucket < LATENCY_BUCKET_BOUNDS_MS.size() &&
+           static_cast<int64_t>(latency_us) > LATENCY_BUCKET_BOUNDS_MS[bucket] * 1000) {
+        bucket++;
+    }
+    latency_buckets[bucket]++;
+}
+
+json RequestStats::snapshot() const {
+    uint64_t n = count.load();
+    json stats;
+    stats["count"] = n;
+    stats["errors"] = errors.load();
+    stats["avg_latency_ms"] = n ? total_latency_us.load() / 1000.0 / n : 0.0;
+    stats["max_latency_ms"] = max_latency_us.load() / 1000.0;
+    stats["db_lock_wait_ms"] = db_lock_wait_us.load() / 1000.0;
+    stats["response_bytes"] = response_bytes.load();
+
+    // latency_counts[i] 는 latency_bounds_ms[i] 이하인 요청 수, 마지막 값은 가장 큰 상한을 넘은 요청 수
+    json counts = json::array();
+    for (const auto& bucket : latency_buckets) counts.push_back(bucket.load());
+    stats["latency_bounds_ms"] = LATENCY_BUCKET_BOUNDS_MS;
+    stats["latency_counts"] = counts;
+    return stats;
+}
+
+/*
+
+디스패처
+
+*/
+
+// 처리 실패 응답 송신 (클라이언트가 correlation_id 로 기다리는 요청을 끝낼 수 있도록 함)
+static void send_error(ResponseWriter& writer, int request_id, const json& correlation_id, const string& error) {
+    json root = make_response(ERROR_RESPONSE_ID, correlation_id);
+    root["failed_request_id"] = request_id;
+    root["error"] = error;
+    // 예외 메시지에 잘못된 UTF-8 이 섞여 있어도 응답은 보내도록 대체 문자로 바꿈
+    writer.send(root.dump(-1, ' ', false, json::error_handler_t::replace));
+}
+
+void RequestDispatcher::register_handler(int request_id, unique_ptr<RequestHandler> handler) {
+    handlers[request_id].handler = move(handler);
+}
+
+void RequestDispatcher::dispatch(const vector<char>& frame, ResponseWriter& writer) {
+    auto start = chrono::steady_clock::now();
+
+    json received_json;
+    int request_id = -1;
+    json correlation_id;
+    try {
+        received_json = json::parse(frame);
+        if (!received_json.is_object()) throw invalid_argument("요청이 JSON 객체가 아님");
+        // 선택 항목: 클라이언트가 붙인 요청 식별자 (응답에 그대로 포함, 아래 검사가 실패해도 오류 응답에 포함되도록 먼저 읽음)
+        correlation_id = received_json.value("correlation_id", json());
+        request_id = received_json.at("request_id").get<int>();
+    } catch (const exception& e) {
+        LOG_ERROR("[Thread " << std::this_thread::get_id() << "] 요청 해석 실패: " << e.what());
+        reject(start, request_id, correlation_id, e.what(), writer);
+        return;
+    }
+    LOG_INFO("[Thread " << std::this_thread::get_id() << "] 수신 성공: request_id " << request_id << " (" << frame.size() << " 바이트)");
+    LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] 수신 내용: " << received_json.dump());
+
+    auto it = handlers.find(request_id);
+    if (it == handlers.end()) {
+        LOG_WARN("[Thread " << std::this_thread::get_id() << "] 알 수 없는 request_id: " << request_id);
+        reject(start, request_id, correlation_id, "unknown request_id", writer);
+        return;
+    }
+
+    auto progress = make_shared<Progress>(Progress{request_id, *it->second.stats, correlation_id, start});
+    const RequestHandler& handler = *it->second.handler;
+    run_step(progress, [&](RequestContext& ctx) { return handler.handle(received_json, ctx); }, writer);
+}
+
+void RequestDispatcher::run_step(shared_ptr<Progress> progress, const RequestStep& step, ResponseWriter& writer) {
+    RequestContext ctx{db_pool, image_store, writer, progress->correlation_id};
+
+    bool failed = false;
+    try {
+        string json_string = step(ctx);
+        if (!json_string.empty()) {
+            LOG_INFO("송신 성공 : (" << json_string.size() << " 바이트)");
+            LOG_DEBUG("송신 내용: " << json_string.substr(0,100) << " # 이후 데이터 출력 생략");
+            writer.send(move(json_string));
+        }
+    } catch (const exception& e) {
+        LOG_ERROR("[Thread " << std::this_thread::get_id() << "] request_id " << progress->request_id << " 처리 실패: " << e.what());
+        failed = true;
+        ctx.continuation = nullptr;
+        send_error(writer, progress->request_id, ctx.correlation_id, e.what());
+    }
+    progress->db_lock_wait += ctx.db_lock_wait;
+    progress->bytes += writer.bytes_sent();
+
+    if (ctx.continuation) {
+        // 송신 대기량이 줄면 이벤트 루프가 워커에서 이어서 실행
+        writer.defer([this, progress, next = move(ctx.continuation)](ResponseWriter& next_writer) {
+            run_step(progress, next, next_writer);
+        });
+        return;
+    }
+    progress->stats.record(chrono::steady_clock::now() - progress->start, progress->db_lock_wait, progress->bytes, failed);
+}
+
+void RequestDispatcher::reject(chrono::steady_clock::time_point start, int request_id, const json& correlation_id,
+                               const string& error, ResponseWriter& writer) {
+    send_error(writer, request_id, correlation_id, error);
+    rejected.record(chrono::steady_clock::now() - start, chrono::nanoseconds(0), writer.bytes_sent(), true);
+}
+
+json RequestDispatcher::metrics_snapshot() const {
+    json metrics = json::object();
+    for (const auto& [request_id, entry] : handlers) {
+        metrics[to_string(request_id)] = entry.stats->snapshot();
+    }
+    metrics["invalid"] = rejected.snapshot();
+    return metrics;
+}
@@ -0,0 +1,160 @@
+// 요청 처리 디스패처 모듈
+// request_id 별 핸들러 객체를 등록해 두고, 수신 프레임을 해석(decode) → 처리(execute) → 응답 생성(encode) 순서로 처리한다.
+// request_id 마다 처리 건수, 지연 시간 히스토그램, DB Lock 대기 시간, 응답 바이트 수를 집계한다.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+// SQLiteC++ 외부 라이브러리
+#include <SQLiteCpp/SQLiteCpp.h>
+
+// json 처리를 위한 외부 헤더파일
+#include "json.hpp"
+
+#include "tcp_event_loop.hpp"
+#include "db_pool.hpp"
+#include "image_store.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+struct RequestContext;
+
+// 송신 대기로 미룬 요청의 나머지 처리, 마지막 응답 프레임을 반환 (또 미루면 빈 문자열)
+using RequestStep = function<string(RequestContext&)>;
+
+// 요청 하나를 처리하는 동안 핸들러가 사용하는 자원과 측정값
+struct RequestContext {
+    DbPool& db_pool;
+    const ImageStore& image_store;
+    ResponseWriter& writer;
+    json correlation_id;                            // 요청에 붙은 식별자 (없으면 null), 모든 응답 프레임에 그대로 포함
+    chrono::nanoseconds db_lock_wait{0};            // 이 요청이 DB 연결(쓰기는 쓰기 연결 = 쓰기 잠금)을 기다린 시간 합계
+    RequestStep continuation;                       // 송신 대기량이 많아 멈춘 스트리밍 응답이 남긴 나머지 처리 (워커를 붙잡고 기다리지 않음)
+};
+
+// DB 연결을 풀에서 빌리는 RAII 객체, 빌리기까지 기다린 시간을 요청 지표에 누적
+// 읽기는 읽기 전용 연결끼리 동시에, 쓰기는 쓰기 연결 하나로 차례대로 실행됨
+class DbLease {
+public:
+    enum Access { READ, WRITE };
+
+    DbLease(RequestContext& ctx, Access access);
+
+    DbHandle& db() { return connection.get(); }
+
+private:
+    DbConnection connection;
+};
+
+// 응답 JSON 생성 (correlation_id 가 있으면 함께 포함)
+json make_response(int request_id, const json& correlation_id);
+
+// 요청을 처리하지 못했을 때의 응답 번호 ({"request_id": 24, "failed_request_id": N, "error": "...", "correlation_id": ...})
+const int ERROR_RESPONSE_ID = 24;
+
+// has_correlation_id 가 훑는 프레임 앞부분 크기
+const size_t CORRELATION_SCAN_LIMIT = 4096;
+
+// 요청 프레임의 최상위 객체에 correlation_id 가 있는지 확인 (이벤트 루프에서 순서 무관 처리 여부 판단에 사용)
+// 이벤트 루프 스레드에서 실행되므로 JSON 을 파싱하지 않고 앞 CORRELATION_SCAN_LIMIT 바이트 안의 최상위 키만 훑음
+// 그 안에서 찾지 못하면 (큰 data 뒤에 붙은 경우 등) 순서 보장 요청으로 처리되며, 응답에는 그대로 포함됨
+bool has_correlation_id(const vector<char>& frame);
+
+// request_id 하나를 처리하는 핸들러
+class RequestHandler {
+public:
+    virtual ~RequestHandler() = default;
+
+    // 요청을 처리하고 송신할 마지막 응답 프레임을 반환 (응답을 이미 ctx.writer 로 보냈으면 빈 문자열)
+    virtual string handle(const json& request, RequestContext& ctx) const = 0;
+};
+
+// 해석/처리/응답 생성 단계를 나눠 구현하는 핸들러
+// Params: 요청에서 꺼낸 인자, Result: 처리 결과
+template <typename Params, typename Result>
+class TypedRequestHandler : public RequestHandler {
+public:
+    string handle(const json& request, RequestContext& ctx) const final {
+        Params params = decode(request);
+        Result result = execute(params, ctx);
+        return encode(result, ctx);
+    }
+
+protected:
+    virtual Params decode(const json& request) const = 0;
+    virtual Result execute(const Params& params, RequestContext& ctx) const = 0;
+    virtual string encode(const Result& result, RequestContext& ctx) const = 0;
+};
+
+// 인자가 없는 요청용
+struct NoParams {};
+
+// 지연 시간 히스토그램 구간 상한 (ms), 마지막 구간 이후는 모두 overflow 구간
+const array<int64_t, 12> LATENCY_BUCKET_BOUNDS_MS = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
+// request_id 하나의 누적 지표 (여러 워커 스레드에서 동시에 갱신)
+struct RequestStats {
+    atomic<uint64_t> count{0};
+    atomic<uint64_t> errors{0};
+    atomic<uint64_t> total_latency_us{0};
+    atomic<uint64_t> max_latency_us{0};
+    atomic<uint64_t> db_lock_wait_us{0};
+    atomic<uint64_t> response_bytes{0};
+    array<atomic<uint64_t>, LATENCY_BUCKET_BOUNDS_MS.size() + 1> latency_buckets{};
+
+    void record(chrono::nanoseconds latency, chrono::nanoseconds db_lock_wait, size_t bytes, bool failed);
+    json snapshot() const;
+};
+
+class RequestDispatcher {
+public:
+    RequestDispatcher(DbPool& db_pool, const ImageStore& image_store) : db_pool(db_pool), image_store(image_store) {}
+
+    // 서버 시작 전에 모두 등록 (등록 후에는 읽기만 하므로 워커 스레드에서 잠금 없이 조회)
+    void register_handler(int request_id, unique_ptr<RequestHandler> handler);
+
+    // 수신 프레임 하나를 처리하고 마지막 응답 프레임을 송신, 워커 스레드에서 실행됨
+    void dispatch(const vector<char>& frame, ResponseWriter& writer);
+
+    // request_id 별 지표 ({"1": {...}, "2": {...}, "invalid": {...}})
+    // invalid 는 해석하지 못했거나 request_id 가 없거나 모르는 번호인 요청
+    json metrics_snapshot() const;
+
+private:
+    struct Entry {
+        unique_ptr<RequestHandler> handler;
+        unique_ptr<RequestStats> stats = make_unique<RequestStats>();
+    };
+
+    // 요청 하나의 누적 측정값 (나머지 처리를 미뤘다가 다른 워커에서 이어서 실행해도 유지)
+    struct Progress {
+        int request_id;
+        RequestStats& stats;
+        json correlation_id;
+        chrono::steady_clock::time_point start;
+        chrono::nanoseconds db_lock_wait{0};
+        size_t bytes = 0;
+    };
+
+    // 요청 처리 한 단계를 실행하고 마지막 응답 프레임을 송신, 핸들러가 나머지를 미뤘으면 writer 에 이어서 실행할 작업을 맡김
+    void run_step(shared_ptr<Progress> progress, const RequestStep& step, ResponseWriter& writer);
+    // 처리할 수 없는 요청에 오류 응답을 보내고 invalid 지표에 기록
+    void reject(chrono::steady_clock::time_point start, int request_id, const json& correlation_id,
+                const string& error, ResponseWriter& writer);
+
+    DbPool& db_pool;
+    const ImageStore& image_store;
+    map<int, Entry> handlers;
+    RequestStats rejected;
+};
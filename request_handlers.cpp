@@ -0,0 +1,745 @@
+#include "request_handlers.hpp"
+#include "tcp_server.hpp"
+#include "config_cache.hpp"
+#include "logger.hpp"
+
+/*
+
+감지 이미지 응답 보조 함수
+
+*/
+
+// --- 바이너리 프레임 본문 생성 ---
+// [4바이트 빅엔디언 JSON 헤더 길이][JSON 헤더][이미지 원본 바이트를 헤더의 data 순서대로 이어붙임]
+// 헤더까지 채운 본문을 반환하고, 이미지 바이트는 호출자가 append_detection_image 로 뒤에 이어씀
+// base64 인코딩과 JSON 문자열 이스케이프 없이 이미지를 그대로 전송하기 위해 사용
+string begin_binary_payload(const json& header, size_t image_bytes) {
+    string header_string = header.dump();
+
+    string payload;
+    payload.reserve(sizeof(uint32_t) + header_string.size() + image_bytes);
+    uint32_t net_header_len = htonl(static_cast<uint32_t>(header_string.size()));
+    payload.append(reinterpret_cast<const char*>(&net_header_len), sizeof(net_header_len));
+    payload.append(header_string);
+    return payload;
+}
+
+// 직접 조립하는 응답 JSON 의 시작 부분 ("correlation_id" 는 "data" 보다 앞에 오므로 json::dump() 의 키 순서와 같음)
+static string response_prefix(const json& correlation_id) {
+    if (correlation_id.is_null()) return "{";
+    return "{\"correlation_id\":" + correlation_id.dump() + ",";
+}
+
+// --- 감지 이미지를 송신 버퍼에 직접 읽어 넣기 ---
+// 아직 DB 에 남아 있는 BLOB 은 DETECTION_IMAGE_CHUNK_SIZE 단위로 읽어 out 뒤에 이어씀 (원본 또는 base64)
+// 이미지 전체를 vector 로 복사하지 않음, reader 는 호출자가 빌린 읽기 연결에 묶여 있음
+// 이미지 저장소 파일은 mmap 된 내용을 한 번에 복사/인코딩
+void append_detection_image(DetectionImageReader& reader, const DetectionRef& detection, string& out, bool encode_base64) {
+    if (detection.imageSize <= 0) return;
+
+    reader.open(detection);
+
+    if (const unsigned char* mapped = reader.mapped_data()) {
+        if (encode_base64) {
+            out.append(base64_encode(mapped, detection.imageSize));
+        } else {
+            out.append(reinterpret_cast<const char*>(mapped), detection.imageSize);
+        }
+        return;
+    }
+
+    if (!encode_base64) {
+        size_t start = out.size();
+        out.resize(start + detection.imageSize);
+        for (int offset = 0; offset < detection.imageSize; offset += DETECTION_IMAGE_CHUNK_SIZE) {
+            int chunk = min(DETECTION_IMAGE_CHUNK_SIZE, detection.imageSize - offset);
+            reader.read(&out[start + offset], chunk, offset);
+        }
+        return;
+    }
+
+    out.reserve(out.size() + (detection.imageSize + 2) / 3 * 4);
+    vector<unsigned char> buffer(DETECTION_IMAGE_CHUNK_SIZE);
+    for (int offset = 0; offset < detection.imageSize; offset += DETECTION_IMAGE_CHUNK_SIZE) {
+        int chunk = min(DETECTION_IMAGE_CHUNK_SIZE, detection.imageSize - offset);
+        reader.read(buffer.data(), chunk, offset);
+        // 청크 크기가 3의 배수이므로 마지막 청크에만 패딩이 붙음
+        out.append(base64_encode(buffer.data(), chunk));
+    }
+}
+
+// base64 이미지가 들어가는 JSON 객체를 직접 조립
+// json 객체에 이미지 문자열을 넣었다가 dump 하는 이중 복사를 피하고, 출력은 json::dump() 와 같은 형식(키 정렬, 공백 없음)
+static void append_detection_json(DetectionImageReader& reader, const DetectionRef& detection, string& out, bool with_id = false) {
+    out += "{";
+    if (with_id) out += "\"id\":" + to_string(detection.id) + ",";
+    out += "\"image\":\"";
+    append_detection_image(reader, detection, out, true);
+    out += "\",\"timestamp\":";
+    out += json(detection.timestamp).dump();
+    out += "}";
+}
+
+// 썸네일을 이미지로 읽기 위한 참조 (썸네일이 아직 없으면 크기 0 → 빈 이미지)
+DetectionRef thumbnail_ref(const DetectionRef& detection) {
+    DetectionRef thumbnail = detection;
+    thumbnail.imageHash = detection.thumbHash;
+    thumbnail.imageSize = detection.thumbHash.empty() ? 0 : detection.thumbSize;
+    return thumbnail;
+}
+
+// 목록 모드 항목 {"id","thumbnail","timestamp"} 를 직접 조립
+static void append_thumbnail_json(DetectionImageReader& reader, const DetectionRef& detection, string& out) {
+    out += "{\"id\":" + to_string(detection.id) + ",\"thumbnail\":\"";
+    append_detection_image(reader, thumbnail_ref(detection), out, true);
+    out += "\",\"timestamp\":";
+    out += json(detection.timestamp).dump();
+    out += "}";
+}
+
+// --- 감지 이미지 스트리밍 응답 ---
+// DETECTION_STREAM_BATCH_SIZE 건씩 (ts_ms, id) 키셋으로 이어 읽어 감지 결과마다 프레임(request_id 16)을 바로 보냄
+// 송신은 기다리지 않으므로 읽기 연결을 빌린 채 보내도 되고, 송신 대기량이 많으면 연결을 반환하고 멈춤 (워커도 반환)
+StreamState stream_detections(DetectionStream& stream, RequestContext& ctx) {
+    try {
+        while (true) {
+            bool binary = ctx.writer.connection_options().binary_frames;
+            int batch = 0;
+
+            DbLease lease(ctx, DbLease::READ);
+            DetectionCursor cursor(lease.db(), stream.after_ms, stream.after_id, stream.end_ms, DETECTION_STREAM_BATCH_SIZE);
+            DetectionImageReader reader(lease.db(), ctx.image_store);
+
+            DetectionRef detection;
+            while (!ctx.writer.congested() && cursor.next(detection)) {
+                bool sent;
+                if (binary) {
+                    json item = make_response(16, ctx.correlation_id);
+                    item["seq"] = stream.count;
+                    item["data"]["timestamp"] = detection.timestamp;
+                    DetectionRef image = detection;
+                    if (stream.thumbnails) {
+                        image = thumbnail_ref(detection);
+                        item["data"]["id"] = detection.id;
+                        item["data"]["thumbnail_size"] = image.imageSize;
+                    } else {
+                        item["data"]["image_size"] = image.imageSize;
+                    }
+                    string payload = begin_binary_payload(item, image.imageSize);
+                    append_detection_image(reader, image, payload, false);
+                    sent = ctx.writer.send_binary(move(payload));
+                } else {
+                    string item = response_prefix(ctx.correlation_id) + "\"data\":";
+                    if (stream.thumbnails) {
+                        append_thumbnail_json(reader, detection, item);
+                    } else {
+                        append_detection_json(reader, detection, item);
+                    }
+                    item += ",\"request_id\":16,\"seq\":" + to_string(stream.count) + "}";
+                    sent = ctx.writer.send(move(item));
+                }
+                if (!sent) {
+                    LOG_INFO("[Thread " << std::this_thread::get_id() << "] 클라이언트 연결 종료로 스트리밍 중단 (" << stream.count << "건 전송)");
+                    return StreamState::CLOSED;
+                }
+                stream.count++;
+                stream.after_ms = detection.tsMs;
+                stream.after_id = detection.id;
+                batch++;
+            }
+
+            if (ctx.writer.congested()) return StreamState::CONGESTED;
+            if (batch < DETECTION_STREAM_BATCH_SIZE) return StreamState::FINISHED;
+        }
+    } catch (const exception& e) {
+        LOG_ERROR("[Thread " << std::this_thread::get_id() << "] 스트리밍 조회 실패 (" << stream.count << "건 전송 후): " << e.what());
+        stream.error = e.what();
+    }
+    return StreamState::FINISHED;
+}
+
+/*
+
+request_id 별 핸들러
+
+*/
+
+namespace {
+
+// --- request_id 1 : 감지 이미지&텍스트 조회 (select) ---
+// data.stream 이 true 이면 한 건씩 프레임(16)으로 보내고 종료 프레임(17)으로 마무리
+// 도중에 조회가 실패하면 종료 프레임에 error 가 붙으며, 이때 count 는 실패 전까지 보낸 건수
+// data.thumbnails 가 true 이면 원본 이미지 대신 id 와 썸네일만 보냄 (원본은 request_id 23 으로 요청)
+// start_timestamp / end_timestamp 는 시각 문자열(시간대가 없으면 KST) 또는 epoch 밀리초 숫자
+struct DetectionQuery {
+    int64_t start_ms;
+    int64_t end_ms;
+    bool stream;
+    bool thumbnails;
+};
+
+// 요청의 시각 값을 epoch 밀리초로 변환 (형식이 틀리면 invalid_argument)
+static int64_t decode_timestamp_ms(const json& data, const string& key) {
+    const json& value = data.at(key);
+    if (value.is_number_integer()) return value.get<int64_t>();
+
+    int64_t epochMs;
+    if (!value.is_string() || !parse_timestamp_ms(value.get<string>(), epochMs)) {
+        throw invalid_argument(key + " 형식 오류: " + value.dump());
+    }
+    return epochMs;
+}
+
+// 감지 결과 목록 응답 생성, 이미지는 이미지 저장소(또는 BLOB)에서 읽어 응답 프레임에 바로 채움
+// thumbnails 이면 원본 대신 id 와 썸네일만 넣음
+// extra 의 키는 "data" 와 "request_id" 사이에 정렬되는 이름이어야 함 (직접 조립하는 JSON 이 json::dump() 와 같은 키 순서가 되도록)
+static string encode_detections(const vector<DetectionRef>& detections, bool thumbnails, RequestContext& ctx, int response_id, const json& extra) {
+    DbLease lease(ctx, DbLease::READ);
+    DetectionImageReader reader(lease.db(), ctx.image_store);
+
+    string json_string;
+    if (ctx.writer.connection_options().binary_frames) {
+        // 바이너리 프레임: JSON 헤더에는 메타데이터만, 이미지 원본은 헤더 뒤에 이어붙임
+        vector<DetectionRef> images;
+        images.reserve(detections.size());
+        for (const auto& detection : detections) {
+            images.push_back(thumbnails ? thumbnail_ref(detection) : detection);
+        }
+
+        json root = make_response(response_id, ctx.correlation_id);
+        json data_array = json::array();
+        size_t image_offset = 0;
+        for (const auto& image : images) {
+            json d_obj;
+            d_obj["timestamp"] = image.timestamp;
+            if (thumbnails) {
+                d_obj["id"] = image.id;
+                d_obj["thumbnail_offset"] = image_offset;
+                d_obj["thumbnail_size"] = image.imageSize;
+            } else {
+                d_obj["image_offset"] = image_offset;
+                d_obj["image_size"] = image.imageSize;
+            }
+            data_array.push_back(d_obj);
+            image_offset += image.imageSize;
+        }
+        root["data"] = data_array;
+        root.update(extra);
+        string payload = begin_binary_payload(root, image_offset);
+        for (const auto& image : images) {
+            append_detection_image(reader, image, payload, false);
+        }
+        LOG_INFO("바이너리 프레임 송신 : (" << payload.size() << " 바이트, " << (thumbnails ? "썸네일 " : "이미지 ") << detections.size() << "건)");
+        ctx.writer.send_binary(move(payload));
+    } else {
+        json_string = response_prefix(ctx.correlation_id) + "\"data\":[";
+        for (size_t i = 0; i < detections.size(); i++) {
+            if (i > 0) json_string += ",";
+            if (thumbnails) {
+                append_thumbnail_json(reader, detections[i], json_string);
+            } else {
+                append_detection_json(reader, detections[i], json_string);
+            }
+        }
+        json_string += "]";
+        for (const auto& [key, value] : extra.items()) {
+            json_string += "," + json(key).dump() + ":" + value.dump();
+        }
+        json_string += ",\"request_id\":" + to_string(response_id) + "}";
+    }
+    return json_string;
+}
+
+struct DetectionQueryResult {
+    bool stream = false;
+    bool thumbnails = false;
+    vector<DetectionRef> detections;
+    string stream_response; // 스트리밍의 종료 프레임 (연결이 끊겼거나 나머지를 미뤘으면 빈 문자열)
+};
+
+// 스트리밍을 이어서 보내고 끝났으면 종료 프레임(17)을 반환
+// 송신 대기로 멈추면 나머지를 ctx.continuation 에 남기고 빈 문자열 (송신 대기량이 줄면 다른 워커에서 이어서 호출됨)
+static string continue_stream(shared_ptr<DetectionStream> stream, RequestContext& ctx) {
+    switch (stream_detections(*stream, ctx)) {
+        case StreamState::CONGESTED:
+            ctx.continuation = [stream](RequestContext& next) { return continue_stream(stream, next); };
+            return "";
+        case StreamState::CLOSED:
+            return "";
+        case StreamState::FINISHED:
+            break;
+    }
+    json root = make_response(17, ctx.correlation_id);
+    root["count"] = stream->count;
+    if (!stream->error.empty()) root["error"] = stream->error;
+    return root.dump(-1, ' ', false, json::error_handler_t::replace);
+}
+
+class SelectDetectionsHandler : public TypedRequestHandler<DetectionQuery, DetectionQueryResult> {
+protected:
+    DetectionQuery decode(const json& request) const override {
+        const json& data = request.at("data");
+        return {decode_timestamp_ms(data, "start_timestamp"), decode_timestamp_ms(data, "end_timestamp"),
+                data.value("stream", false), data.value("thumbnails", false)};
+    }
+
+    DetectionQueryResult execute(const DetectionQuery& query, RequestContext& ctx) const override {
+        DetectionQueryResult result;
+        result.stream = query.stream;
+        result.thumbnails = query.thumbnails;
+        if (query.stream) {
+            // 클라이언트의 이미지&텍스트 스트리밍 요청(select) 신호 (after_id -1: start_ms 의 첫 행부터)
+            auto stream = make_shared<DetectionStream>(DetectionStream{query.start_ms, -1, query.end_ms, query.thumbnails});
+            result.stream_response = continue_stream(stream, ctx);
+            return result;
+        }
+
+        // 클라이언트의 이미지&텍스트 요청(select) 신호
+        // --- DB 연결을 빌려 접근 ---
+        {
+            DbLease lease(ctx, DbLease::READ);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 조회 시작 (읽기 연결 획득)");
+            result.detections = select_refs_for_timestamp_range_detections(lease.db(), query.start_ms, query.end_ms);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 조회 완료 (읽기 연결 반환)");
+        }
+        // --- 연결 반환 ---
+        return result;
+    }
+
+    string encode(const DetectionQueryResult& result, RequestContext& ctx) const override {
+        if (result.stream) return result.stream_response;
+        return encode_detections(result.detections, result.thumbnails, ctx, 10, json::object());
+    }
+};
+
+// --- request_id 22 : 감지 이미지&텍스트 페이지 조회 ---
+// (10 은 request_id 1 의 응답 번호이므로 요청 번호로 쓰지 않음, 요청/응답 번호가 겹치지 않게 응답 번호 다음부터 사용)
+// OFFSET 없이 (ts_ms, id) 키셋으로 이어 읽으므로 뒤 페이지도 인덱스 탐색 한 번으로 시작
+// data.cursor 는 이전 응답(20)의 next_cursor 를 그대로 전달 (첫 페이지는 생략), 마지막 페이지면 next_cursor 가 null
+// data.thumbnails 는 request_id 1 과 같음
+struct DetectionPageQuery {
+    int64_t after_ms;
+    int64_t after_id;
+    int64_t end_ms;
+    int page_size;
+    bool thumbnails;
+};
+
+struct DetectionPage {
+    vector<DetectionRef> detections;
+    bool has_more = false;
+    bool thumbnails = false;
+};
+
+// 페이지 이어 읽기 위치 (클라이언트에는 해석하지 않는 문자열로 전달)
+static string encode_page_cursor(const DetectionRef& last) {
+    return to_string(last.tsMs) + "." + to_string(last.id);
+}
+
+static void decode_page_cursor(const string& cursor, int64_t& after_ms, int64_t& after_id) {
+    size_t dot = cursor.find('.');
+    size_t ms_end = 0, id_end = 0;
+    try {
+        if (dot == string::npos) throw invalid_argument("구분자 없음");
+        after_ms = stoll(cursor.substr(0, dot), &ms_end);
+        after_id = stoll(cursor.substr(dot + 1), &id_end);
+    } catch (const exception&) {
+        throw invalid_argument("cursor 형식 오류: " + cursor);
+    }
+    if (ms_end != dot || id_end != cursor.size() - dot - 1) {
+        throw invalid_argument("cursor 형식 오류: " + cursor);
+    }
+}
+
+class SelectDetectionPageHandler : public TypedRequestHandler<DetectionPageQuery, DetectionPage> {
+protected:
+    DetectionPageQuery decode(const json& request) const override {
+        const json& data = request.at("data");
+        DetectionPageQuery query;
+        query.end_ms = decode_timestamp_ms(data, "end_timestamp");
+        query.page_size = clamp(data.value("page_size", DETECTION_PAGE_SIZE_DEFAULT), 1, DETECTION_PAGE_SIZE_MAX);
+        query.thumbnails = data.value("thumbnails", false);
+
+        string cursor = data.value("cursor", "");
+        if (cursor.empty()) {
+            // 첫 페이지: start_timestamp 와 같은 시각의 행부터 포함
+            query.after_ms = decode_timestamp_ms(data, "start_timestamp");
+            query.after_id = -1;
+        } else {
+            decode_page_cursor(cursor, query.after_ms, query.after_id);
+        }
+        return query;
+    }
+
+    DetectionPage execute(const DetectionPageQuery& query, RequestContext& ctx) const override {
+        DetectionPage page;
+        page.thumbnails = query.thumbnails;
+        {
+            DbLease lease(ctx, DbLease::READ);
+            // 한 건 더 읽어 다음 페이지가 있는지 확인
+            page.detections = select_refs_page_detections(lease.db(), query.after_ms, query.after_id, query.end_ms, query.page_size + 1);
+        }
+        if (page.detections.size() > static_cast<size_t>(query.page_size)) {
+            page.detections.pop_back();
+            page.has_more = true;
+        }
+        return page;
+    }
+
+    string encode(const DetectionPage& page, RequestContext& ctx) const override {
+        json extra;
+        extra["next_cursor"] = page.has_more ? json(encode_page_cursor(page.detections.back())) : json();
+        return encode_detections(page.detections, page.thumbnails, ctx, 20, extra);
+    }
+};
+
+// --- request_id 23 : 감지 원본 이미지 한 건 조회 ---
+// (11 은 request_id 2 의 응답 번호이므로 요청 번호로 쓰지 않음)
+// 목록 모드(thumbnails)로 받은 id 로 원본을 요청, 응답(21)의 data 는 {"id","image","timestamp"} (없는 id 면 null)
+// 바이너리 프레임이면 헤더 data 에 {"id","image_size","timestamp"}, 이미지 원본은 헤더 뒤에 이어붙임
+struct OptionalDetection {
+    bool found = false;
+    DetectionRef detection;
+};
+
+class SelectDetectionImageHandler : public TypedRequestHandler<int64_t, OptionalDetection> {
+protected:
+    int64_t decode(const json& request) const override {
+        return request.at("data").at("id").get<int64_t>();
+    }
+
+    OptionalDetection execute(const int64_t& id, RequestContext& ctx) const override {
+        OptionalDetection result;
+        {
+            DbLease lease(ctx, DbLease::READ);
+            result.found = select_ref_by_id_detections(lease.db(), id, result.detection);
+        }
+        return result;
+    }
+
+    string encode(const OptionalDetection& result, RequestContext& ctx) const override {
+        if (!result.found) {
+            json root = make_response(21, ctx.correlation_id);
+            root["data"] = nullptr;
+            return root.dump();
+        }
+
+        const DetectionRef& detection = result.detection;
+        DbLease lease(ctx, DbLease::READ);
+        DetectionImageReader reader(lease.db(), ctx.image_store);
+        if (ctx.writer.connection_options().binary_frames) {
+            json root = make_response(21, ctx.correlation_id);
+            root["data"]["id"] = detection.id;
+            root["data"]["image_size"] = detection.imageSize;
+            root["data"]["timestamp"] = detection.timestamp;
+            string payload = begin_binary_payload(root, detection.imageSize);
+            append_detection_image(reader, detection, payload, false);
+            ctx.writer.send_binary(move(payload));
+            return "";
+        }
+
+        string json_string = response_prefix(ctx.correlation_id) + "\"data\":";
+        append_detection_json(reader, detection, json_string, true);
+        json_string += ",\"request_id\":21}";
+        return json_string;
+    }
+};
+
+// --- request_id 2 : 가상 라인 좌표값 - 도트 매트릭스 매핑 요청 (insert) ---
+class InsertLineHandler : public TypedRequestHandler<CrossLine, bool> {
+protected:
+    CrossLine decode(const json& request) const override {
+        const json& data = request.at("data");
+        return {data.value("index", -1), data.value("x1", -1), data.value("y1", -1), data.value("x2", -1), data.value("y2", -1),
+                data.value("name", "name1"), data.value("mode", "BothDirections"),
+                data.value("leftMatrixNum", -1), data.value("rightMatrixNum", -1)};
+    }
+
+    bool execute(const CrossLine& line, RequestContext& ctx) const override {
+        // 카메라에는 4배 해상도 좌표로 등록
+        CrossLine newCrossLine = {line.index, line.x1*4, line.y1*4, line.x2*4, line.y2*4, line.name, line.mode, line.leftMatrixNum, line.rightMatrixNum};
+
+        putLines(newCrossLine);
+
+        bool mappingSuccess;
+        // --- DB 연결을 빌려 접근 ---
+        {
+            DbLease lease(ctx, DbLease::WRITE);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삽입 시작 (쓰기 연결 획득)");
+            mappingSuccess = insert_data_lines(lease.db(), line.index, line.x1, line.y1, line.x2, line.y2, line.name, line.mode, line.leftMatrixNum, line.rightMatrixNum);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삽입 완료 (쓰기 연결 반환)");
+        }
+        // --- 연결 반환 ---
+        return mappingSuccess;
+    }
+
+    string encode(const bool& mappingSuccess, RequestContext& ctx) const override {
+        json root = make_response(11, ctx.correlation_id);
+        root["mapping_success"] = (mappingSuccess == true)?1:0;
+        return root.dump();
+    }
+};
+
+// --- request_id 3 : 감지선 좌표값 요청 (select all) ---
+// getLine해서 기존 라인 정보 들고오기
+// db의 select all해서 라인 정보 들고오기
+// db에는 delete all하고 일치하는 부분만 다시 insert
+// 패킷은 일치하는 것만 전송
+class SyncLinesHandler : public TypedRequestHandler<NoParams, vector<CrossLine>> {
+protected:
+    NoParams decode(const json&) const override { return {}; }
+
+    vector<CrossLine> execute(const NoParams&, RequestContext& ctx) const override {
+        vector<CrossLine> httpLines;
+        // JSON 문자열 파싱
+        json j = json::parse(getLines());
+
+        // "lineCrossing" 배열의 첫 번째 요소 안에 있는 "line" 배열을 순회
+        for (const auto& item : j["lineCrossing"][0]["line"]) {
+            CrossLine cl; // 임시 CrossLine 객체 생성
+
+            // 각 필드 값 추출
+            cl.index = item["index"];
+            cl.name = item["name"];
+            cl.mode = item["mode"];
+
+            // lineCoordinates 배열에서 좌표 추출
+            cl.x1 = item["lineCoordinates"][0]["x"];
+            cl.y1 = item["lineCoordinates"][0]["y"];
+            cl.x2 = item["lineCoordinates"][1]["x"];
+            cl.y2 = item["lineCoordinates"][1]["y"];
+
+            // 완성된 객체를 벡터에 추가
+            httpLines.push_back(cl);
+        }
+
+        // --- 조회부터 다시 채우기까지 쓰기 연결 하나로 처리 (중간에 다른 쓰기가 끼어들지 않음) ---
+        DbLease lease(ctx, DbLease::WRITE);
+        // 설정 변경은 쓰기 연결에서만 일어나고 바로 캐시에 반영되므로, 쓰기 연결을 잡은 동안 캐시는 DB 와 같음
+        vector<CrossLine> dbLines = config_cache().snapshot()->lines;
+        LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] 설정 캐시 조회 완료 (쓰기 연결 획득)");
+
+        vector<CrossLine> realLines;
+        for(auto httpLine:httpLines){
+            for(auto dbLine:dbLines){
+                if(httpLine.index == dbLine.index){
+                    realLines.push_back(dbLine);
+                }
+            }
+        }
+
+        // lines 테이블 비우고 실제 CCTV에 있는 가상선으로만 DB 채우기
+        LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삭제 시작");
+        delete_all_data_lines(lease.db());
+        LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삭제 완료");
+        for(auto realLine:realLines){
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삽입 시작");
+            insert_data_lines(lease.db(),realLine.index,realLine.x1,realLine.y1,realLine.x2,realLine.y2,realLine.name,realLine.mode,realLine.leftMatrixNum,realLine.rightMatrixNum);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삽입 완료");
+        }
+        LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] 쓰기 연결 반환");
+        return realLines;
+    }
+
+    string encode(const vector<CrossLine>& realLines, RequestContext& ctx) const override {
+        json root = make_response(12, ctx.correlation_id);
+        json data_array = json::array();
+        for (const auto& line : realLines) {
+            json d_obj;
+            d_obj["index"] = line.index;
+            d_obj["x1"] = line.x1;
+            d_obj["y1"] = line.y1;
+            d_obj["x2"] = line.x2;
+            d_obj["y2"] = line.y2;
+            d_obj["name"] = line.name;
+            d_obj["mode"] = line.mode;
+            d_obj["right_matrix_num"] = line.rightMatrixNum;
+            d_obj["left_matrix_num"] = line.leftMatrixNum;
+            data_array.push_back(d_obj);
+        }
+        root["data"] = data_array;
+        return root.dump();
+    }
+};
+
+// --- request_id 4 : 라인 전체 삭제 ---
+// getLines로 라인들 인덱스 들고오기
+// cctv에선 들고온 인덱스로 deleteline(index) 반복 호출해서 삭제
+// db에선 delete_all 호출해서 전부 삭제
+class DeleteLinesHandler : public TypedRequestHandler<NoParams, bool> {
+protected:
+    NoParams decode(const json&) const override { return {}; }
+
+    bool execute(const NoParams&, RequestContext& ctx) const override {
+        vector<int> indexs;
+        json j = json::parse(getLines());
+
+        for (const auto& item : j["lineCrossing"][0]["line"]) {
+            indexs.push_back(item["index"]);
+        }
+
+        for(int index:indexs){
+            deleteLines(index);
+        }
+
+        bool deleteSuccess;
+        // --- DB 연결을 빌려 접근 ---
+        {
+            DbLease lease(ctx, DbLease::WRITE);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 조회 시작 (쓰기 연결 획득)");
+            deleteSuccess = delete_all_data_lines(lease.db());
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 조회 완료 (쓰기 연결 반환)");
+        }
+        // --- 연결 반환 ---
+        return deleteSuccess;
+    }
+
+    string encode(const bool& deleteSuccess, RequestContext& ctx) const override {
+        json root = make_response(13, ctx.correlation_id);
+        root["delete_success"] = (deleteSuccess==true)?1:0;
+        return root.dump();
+    }
+};
+
+// --- request_id 5 : 도로기준선 insert ---
+class InsertBaseLineHandler : public TypedRequestHandler<BaseLine, bool> {
+protected:
+    BaseLine decode(const json& request) const override {
+        const json& data = request.at("data");
+        return {data.value("index", -1), data.value("matrixNum1", -1), data.value("x1", -1), data.value("y1", -1),
+                data.value("matrixNum2", -1), data.value("x2", -1), data.value("y2", -1)};
+    }
+
+    bool execute(const BaseLine& baseLine, RequestContext& ctx) const override {
+        bool insertSuccess;
+        // --- DB 연결을 빌려 접근 ---
+        {
+            DbLease lease(ctx, DbLease::WRITE);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삽입 시작 (쓰기 연결 획득)");
+            insertSuccess = insert_data_baseLines(lease.db(), baseLine);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삽입 완료 (쓰기 연결 반환)");
+        }
+        // --- 연결 반환 ---
+        return insertSuccess;
+    }
+
+    string encode(const bool& insertSuccess, RequestContext& ctx) const override {
+        json root = make_response(14, ctx.correlation_id);
+        root["insert_success"] = (insertSuccess == true)?1:0;
+        return root.dump();
+    }
+};
+
+// --- request_id 6 : 감지선의 수직선 방정식 insert ---
+class InsertVerticalLineHandler : public TypedRequestHandler<VerticalLineEquation, bool> {
+protected:
+    VerticalLineEquation decode(const json& request) const override {
+        const json& data = request.at("data");
+        return {data.value("index", -1), data.value("a", -1.0), data.value("b", -1.0)}; // ax+b = y
+    }
+
+    bool execute(const VerticalLineEquation& equation, RequestContext& ctx) const override {
+        bool insertSuccess;
+        // --- DB 연결을 빌려 접근 ---
+        {
+            DbLease lease(ctx, DbLease::WRITE);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삽입 시작 (쓰기 연결 획득)");
+            insertSuccess = insert_data_verticalLineEquations(lease.db(), equation.index, equation.a, equation.b);
+            LOG_DEBUG("[Thread " << std::this_thread::get_id() << "] DB 삽입 완료 (쓰기 연결 반환)");
+        }
+        // --- 연결 반환 ---
+        return insertSuccess;
+    }
+
+    string encode(const bool& insertSuccess, RequestContext& ctx) const override {
+        json root = make_response(14, ctx.correlation_id);
+        root["insert_success"] = (insertSuccess == true)?1:0;
+        return root.dump();
+    }
+};
+
+// --- request_id 7 : 도로기준선 select all (동기화) ---
+class SelectBaseLinesHandler : public TypedRequestHandler<NoParams, vector<BaseLine>> {
+protected:
+    NoParams decode(const json&) const override { return {}; }
+
+    vector<BaseLine> execute(const NoParams&, RequestContext&) const override {
+        // DB 연결 없이 설정 캐시 스냅샷에서 바로 읽음
+        return config_cache().snapshot()->baseLines;
+    }
+
+    string encode(const vector<BaseLine>& baseLines, RequestContext& ctx) const override {
+        json root = make_response(15, ctx.correlation_id);
+        json data_array = json::array();
+        for (const auto& baseLine : baseLines) {
+            json d_obj;
+            d_obj["index"] = baseLine.index;
+            d_obj["matrixNum1"] = baseLine.matrixNum1;
+            d_obj["x1"] = baseLine.x1;
+            d_obj["y1"] = baseLine.y1;
+            d_obj["matrixNum2"] = baseLine.matrixNum2;
+            d_obj["x2"] = baseLine.x2;
+            d_obj["y2"] = baseLine.y2;
+            data_array.push_back(d_obj);
+        }
+        root["data"] = data_array;
+        return root.dump();
+    }
+};
+
+// --- request_id 8 : 프로토콜 협상 (이미지 응답을 바이너리 프레임으로 받을지 여부) ---
+class NegotiateHandler : public TypedRequestHandler<bool, bool> {
+protected:
+    bool decode(const json& request) const override {
+        return request.at("data").value("binary_frames", false);
+    }
+
+    bool execute(const bool& binary_frames, RequestContext& ctx) const override {
+        ctx.writer.connection_options().binary_frames = binary_frames;
+        return binary_frames;
+    }
+
+    string encode(const bool& binary_frames, RequestContext& ctx) const override {
+        json root = make_response(18, ctx.correlation_id);
+        root["binary_frames"] = binary_frames;
+        return root.dump();
+    }
+};
+
+// --- request_id 9 : 서버 요청 처리 지표 조회 ---
+class MetricsHandler : public TypedRequestHandler<NoParams, json> {
+public:
+    explicit MetricsHandler(const RequestDispatcher& dispatcher) : dispatcher(dispatcher) {}
+
+protected:
+    NoParams decode(const json&) const override { return {}; }
+
+    json execute(const NoParams&, RequestContext&) const override {
+        return dispatcher.metrics_snapshot();
+    }
+
+    string encode(const json& metrics, RequestContext& ctx) const override {
+        json root = make_response(19, ctx.correlation_id);
+        root["data"] = metrics;
+        return root.dump();
+    }
+
+private:
+    const RequestDispatcher& dispatcher;
+};
+
+} // namespace
+
+void register_request_handlers(RequestDispatcher& dispatcher) {
+    dispatcher.register_handler(1, make_unique<SelectDetectionsHandler>());
+    dispatcher.register_handler(2, make_unique<InsertLineHandler>());
+    dispatcher.register_handler(3, make_unique<SyncLinesHandler>());
+    dispatcher.register_handler(4, make_unique<DeleteLinesHandler>());
+    dispatcher.register_handler(5, make_unique<InsertBaseLineHandler>());
+    dispatcher.register_handler(6, make_unique<InsertVerticalLineHandler>());
+    dispatcher.register_handler(7, make_unique<SelectBaseLinesHandler>());
+    dispatcher.register_handler(8, make_unique<NegotiateHandler>());
+    dispatcher.register_handler(9, make_unique<MetricsHandler>(dispatcher));
+    dispatcher.register_handler(22, make_unique<SelectDetectionPageHandler>());
+    dispatcher.register_handler(23, make_unique<SelectDetectionImageHandler>());
+}
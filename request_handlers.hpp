@@ -0,0 +1,47 @@
+// 클라이언트 요청 핸들러 모듈
+// request_id 1~9, 22, 23 의 요청 해석, DB/카메라 처리, 응답 생성을 핸들러 객체로 구현해 디스패처에 등록한다.
+
+#pragma once
+
+#include "request_dispatcher.hpp"
+#include "db_management.hpp"
+
+// 페이지 조회(request_id 22) 한 번에 보내는 감지 결과 수 (요청의 page_size 는 1 ~ 최대값으로 제한)
+const int DETECTION_PAGE_SIZE_DEFAULT = 20;
+const int DETECTION_PAGE_SIZE_MAX = 50;
+
+// 스트리밍 응답(request_id 1 의 stream)에서 읽기 연결 하나로 읽는 최대 감지 결과 수
+// (클라이언트가 빨리 읽어 송신 대기가 생기지 않아도 읽기 스냅샷을 오래 붙잡지 않도록 이만큼마다 연결을 반환하고 키셋으로 다시 탐색)
+const int DETECTION_STREAM_BATCH_SIZE = 8;
+
+// 모든 request_id 핸들러를 등록
+void register_request_handlers(RequestDispatcher& dispatcher);
+
+// 바이너리 프레임 본문의 앞부분([4바이트 JSON 헤더 길이][JSON 헤더]) 생성, 이미지 바이트는 뒤에 이어씀
+string begin_binary_payload(const json& header, size_t image_bytes);
+
+// 감지 이미지를 이미지 저장소(또는 아직 옮기지 않은 BLOB)에서 읽어 out 뒤에 이어씀 (원본 또는 base64)
+void append_detection_image(DetectionImageReader& reader, const DetectionRef& detection, string& out, bool encode_base64);
+
+// 썸네일을 이미지로 읽기 위한 참조 (imageHash/imageSize 를 썸네일 것으로 바꿈, 썸네일이 없으면 크기 0)
+DetectionRef thumbnail_ref(const DetectionRef& detection);
+
+// 감지 결과 스트리밍 진행 상태 (송신 대기로 멈췄다가 (after_ms, after_id) 다음부터 이어서 보냄)
+struct DetectionStream {
+    int64_t after_ms;
+    int64_t after_id;
+    int64_t end_ms;
+    bool thumbnails;                // 원본 대신 id 와 썸네일만 보냄
+    size_t count = 0;               // 보낸 프레임(16) 수
+    string error;                   // 조회가 도중에 실패했으면 오류 메시지
+};
+
+enum class StreamState {
+    FINISHED,                       // 끝까지 보냈거나 조회가 실패함 (stream.error)
+    CONGESTED,                      // 송신 대기량이 SEND_HIGH_WATER_MARK 에 닿아 멈춤, 같은 stream 으로 다시 호출하면 이어서 보냄
+    CLOSED                          // 연결이 끊겨 중단
+};
+
+// stream 의 다음 감지 결과를 한 건씩 프레임(request_id 16)으로 송신
+// 프레임은 만들자마자 보내므로 메모리에는 송신 대기량 상한 + 프레임 하나까지만 쌓이고, 읽기 연결은 멈출 때 반환함
+StreamState stream_detections(DetectionStream& stream, RequestContext& ctx);
@@ -3,6 +3,7 @@
 // 이 코드의 RTSP 서버 주소 : rtsp://<ip주소>:8554/retransmit
 
 #include "rtsp_server.hpp"
+#include "logger.hpp"
 
 
 
@@ -11,7 +12,7 @@ void rtsp_run(int argc, char *argv[]){
     GError *error = NULL;
     gboolean initialized = gst_init_check(&argc,&argv,&error);
     if(!initialized){
-        g_printerr("GStreamer 초기화 실패: %s\n", error->message);
+        LOG_ERROR("GStreamer 초기화 실패: " << error->message);
         g_error_free(error);
         return;
     }
@@ -41,11 +42,11 @@ void rtsp_run(int argc, char *argv[]){
 
     // RTSP 서버 시작
     if (gst_rtsp_server_attach(server, NULL) == 0) {
-        cerr << "RTSP 서버 Attach 실패\n";
+        LOG_ERROR("RTSP 서버 Attach 실패");
         return;
     }
 
-    cout << "RTSP middle server is running \n";
+    LOG_INFO("RTSP middle server is running");
 
     // 메인 루프 실행
     GMainLoop *loop = g_main_loop_new(NULL, FALSE);
@@ -0,0 +1,17 @@
+#include "statement_cache.hpp"
+
+CachedStatement::~CachedStatement() {
+    if (!statement) return;
+    // 실행 중 예외가 났어도 다음 사용을 위해 상태만 되돌림 (reset 오류 코드는 이미 실행 시점에 예외로 보고됨)
+    statement->tryReset();
+    statement->clearBindings();
+}
+
+CachedStatement DbHandle::prepare(const string& sql) {
+    auto it = statements.find(sql);
+    if (it == statements.end()) {
+        // 스키마가 바뀌어도 sqlite3_prepare_v2 로 준비된 문장은 다음 실행 시 자동으로 다시 준비됨
+        it = statements.emplace(sql, make_unique<SQLite::Statement>(*this, sql)).first;
+    }
+    return CachedStatement(*it->second);
+}
@@ -0,0 +1,49 @@
+// prepared statement 캐시 모듈
+// DB 연결마다 SQL 문자열을 키로 준비된 문장(SQLite::Statement)을 보관해 두고,
+// 같은 SQL 을 다시 실행할 때 파싱/실행 계획 수립 없이 바인딩만 바꿔 재사용한다.
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+// SQLiteC++ 외부 라이브러리
+#include <SQLiteCpp/SQLiteCpp.h>
+
+using namespace std;
+
+// 캐시에서 빌린 문장, 소멸 시 reset + clearBindings 로 다음 사용을 준비
+// (SELECT 를 끝까지 읽지 않고 빠져나와도 읽기 트랜잭션이 열린 채로 남지 않음)
+class CachedStatement {
+public:
+    explicit CachedStatement(SQLite::Statement& statement) : statement(&statement) {}
+    CachedStatement(CachedStatement&& other) noexcept : statement(other.statement) { other.statement = nullptr; }
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+    CachedStatement& operator=(CachedStatement&&) = delete;
+    ~CachedStatement();
+
+    SQLite::Statement* operator->() { return statement; }
+    SQLite::Statement& operator*() { return *statement; }
+
+private:
+    SQLite::Statement* statement;
+};
+
+// prepared statement 캐시를 가진 DB 연결
+// 연결 하나는 한 번에 한 스레드만 사용하므로 캐시에 잠금이 없음
+class DbHandle : public SQLite::Database {
+public:
+    using SQLite::Database::Database;
+
+    // sql 의 준비된 문장을 반환 (처음 사용하는 sql 이면 준비해서 캐시에 보관)
+    // 같은 sql 을 동시에 두 번 빌리면 안 됨 (앞서 빌린 문장이 소멸된 뒤에 다시 빌릴 것)
+    CachedStatement prepare(const string& sql);
+
+    // 캐시된 문장 수
+    size_t cached_statements() const { return statements.size(); }
+
+private:
+    unordered_map<string, unique_ptr<SQLite::Statement>> statements;
+};
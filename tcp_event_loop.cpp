@@ -0,0 +1,581 @@
+#include "tcp_event_loop.hpp"
+#include "tcp_server.hpp"
+#include "logger.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <climits>
+#include <limits>
+#include <stdexcept>
+
+// 한 번에 처리할 epoll 이벤트 수, SSL_read 버퍼 크기
+const int MAX_EVENTS = 64;
+const size_t READ_CHUNK_SIZE = 16 * 1024;
+
+// epoll_event.data.u64 에 넣는 식별자 (연결은 1부터 시작하는 id 사용)
+const uint64_t LISTEN_TOKEN = 0;
+const uint64_t WAKEUP_TOKEN = numeric_limits<uint64_t>::max();
+
+bool FlowControl::reserve(size_t bytes) {
+    lock_guard<mutex> lock(flow_mutex);
+    if (closed) return false;
+    queued_bytes += bytes;
+    return true;
+}
+
+void FlowControl::release(size_t bytes) {
+    lock_guard<mutex> lock(flow_mutex);
+    queued_bytes -= min(bytes, queued_bytes);
+}
+
+bool FlowControl::congested() {
+    lock_guard<mutex> lock(flow_mutex);
+    return queued_bytes >= SEND_HIGH_WATER_MARK;
+}
+
+void FlowControl::close() {
+    lock_guard<mutex> lock(flow_mutex);
+    closed = true;
+}
+
+bool ResponseWriter::send(string payload) {
+    return send_frame(move(payload), 0);
+}
+
+bool ResponseWriter::send_binary(string payload) {
+    return send_frame(move(payload), BINARY_FRAME_FLAG);
+}
+
+bool ResponseWriter::send_frame(string payload, uint32_t flags) {
+    // 길이 헤더의 최상위 비트는 BINARY_FRAME_FLAG 이므로 그보다 작아야 함 (넘으면 요청 실패로 처리되어 오류 응답이 나감)
+    if (payload.size() >= BINARY_FRAME_FLAG) {
+        throw length_error("응답 프레임이 너무 큼 (" + to_string(payload.size()) + " 바이트)");
+    }
+    size_t frame_size = payload.size() + sizeof(uint32_t);
+    if (!flow->reserve(frame_size)) return false;
+    sent_bytes += frame_size;
+    loop->post_frame(connection_id, move(payload), flags);
+    return true;
+}
+
+EventLoop::EventLoop(SSL_CTX* ctx, WorkerPool& pool, FrameHandler on_frame)
+    : ssl_ctx(ctx), pool(pool), on_frame(move(on_frame)),
+      max_in_flight(max<size_t>(1, min(MAX_IN_FLIGHT_PER_CONNECTION, pool.size() - 1))) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        LOG_ERROR("epoll 생성 실패: " << strerror(errno));
+        return;
+    }
+
+    wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd < 0) {
+        LOG_ERROR("eventfd 생성 실패: " << strerror(errno));
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKEUP_TOKEN;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev) < 0) {
+        LOG_ERROR("epoll 등록 실패: " << strerror(errno));
+    }
+}
+
+EventLoop::~EventLoop() {
+    vector<uint64_t> ids;
+    for (auto& [id, conn] : connections) ids.push_back(id);
+    for (uint64_t id : ids) close_connection(id);
+
+    if (server_fd >= 0) close(server_fd);
+    if (wakeup_fd >= 0) close(wakeup_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+}
+
+void EventLoop::set_open_handler(OpenHandler handler) {
+    on_open = move(handler);
+}
+
+void EventLoop::set_frame_classifier(FrameClassifier classifier) {
+    is_unordered = move(classifier);
+}
+
+bool EventLoop::listen_on(int port) {
+    if (epoll_fd < 0 || wakeup_fd < 0) return false;
+
+    server_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server_fd < 0) { LOG_ERROR("Socket Failed: " << strerror(errno)); return false; }
+
+    int opt = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) { LOG_ERROR("Bind Failed: " << strerror(errno)); return false; }
+    if (listen(server_fd, SOMAXCONN) < 0) { LOG_ERROR("Listen Failed: " << strerror(errno)); return false; }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = LISTEN_TOKEN;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_fd, &ev) < 0) {
+        LOG_ERROR("epoll 등록 실패: " << strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::run() {
+    struct epoll_event events[MAX_EVENTS];
+
+    while (true) {
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("epoll_wait 실패: " << strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < n; i++) {
+            uint64_t token = events[i].data.u64;
+            if (token == LISTEN_TOKEN) {
+                accept_clients();
+                continue;
+            }
+            if (token == WAKEUP_TOKEN) {
+                drain_completions();
+                continue;
+            }
+
+            auto it = connections.find(token);
+            if (it == connections.end()) continue;
+
+            Connection& conn = *it->second;
+            if (handle_event(conn, events[i].events)) {
+                update_interest(conn);
+            } else {
+                close_connection(token);
+            }
+        }
+    }
+}
+
+/*
+
+워커 스레드 ↔ 이벤트 루프 연동
+
+*/
+
+void EventLoop::post_frame(uint64_t connection_id, string payload, uint32_t flags) {
+    post(Completion{connection_id, move(payload), flags, false, false, nullptr});
+}
+
+void EventLoop::post(Completion completion) {
+    {
+        lock_guard<mutex> lock(completions_mutex);
+        completions.push_back(move(completion));
+    }
+    uint64_t one = 1;
+    ssize_t written = write(wakeup_fd, &one, sizeof(one));
+    (void)written; // 카운터가 이미 0 이 아니면 EAGAIN 이어도 깨어나는 데 문제 없음
+}
+
+void EventLoop::drain_completions() {
+    uint64_t counter;
+    while (read(wakeup_fd, &counter, sizeof(counter)) > 0) {}
+
+    vector<Completion> ready;
+    {
+        lock_guard<mutex> lock(completions_mutex);
+        ready.swap(completions);
+    }
+
+    vector<uint64_t> touched;
+    for (auto& completion : ready) {
+        auto it = connections.find(completion.connection_id);
+        if (it == connections.end()) continue; // 이미 끊어진 연결
+
+        Connection& conn = *it->second;
+        if (!completion.payload.empty()) {
+            send_frame(conn, completion.payload, completion.flags);
+            conn.flow_bytes_pending += completion.payload.size() + sizeof(uint32_t);
+        }
+        if (completion.continuation) {
+            // 송신 대기로 미뤄진 요청: 처리 중인 요청 수는 그대로 두고 송신 대기량이 줄면 다시 제출
+            conn.parked.push_back(ParkedRequest{move(completion.continuation), completion.ordered});
+            schedule(conn);
+        }
+        if (completion.request_done) {
+            if (completion.ordered) {
+                conn.ordered_in_flight = false;
+            } else {
+                conn.unordered_in_flight--;
+            }
+            schedule(conn);
+        }
+        touched.push_back(completion.connection_id);
+    }
+
+    // 워커 풀에 자리가 생겼으므로 제출을 기다리던 연결부터 처리
+    retry_starved();
+
+    for (uint64_t id : touched) {
+        auto it = connections.find(id);
+        if (it == connections.end()) continue;
+
+        Connection& conn = *it->second;
+        // 대기 프레임이 줄어 수신을 재개할 수 있으면, SSL 내부 버퍼에 남은 데이터부터 처리
+        bool ok = conn.pending_frames.size() < MAX_PENDING_FRAMES ? do_read(conn) : true;
+        if (ok) ok = flush(conn);
+        if (ok) schedule(conn);
+
+        if (ok) {
+            update_interest(conn);
+        } else {
+            close_connection(id);
+        }
+    }
+}
+
+// 연결의 대기 프레임을 처리 가능한 만큼 워커 풀에 제출
+// 순서 보장 요청은 연결당 하나씩 수신 순서대로 처리하고, 순서 무관 요청은 앞선 요청을 기다리지 않고 바로 제출
+// 송신 대기량이 상한 이상인 연결은 아무것도 제출하지 않음 (flush 로 줄어든 뒤 다시 호출됨)
+void EventLoop::schedule(Connection& conn) {
+    if (conn.starved || conn.flow->congested()) return;
+
+    // 미뤄 둔 요청부터 이어서 처리 (이미 처리 중인 요청 수에 포함되어 있음)
+    while (!conn.parked.empty()) {
+        ParkedRequest& parked = conn.parked.front();
+        if (!submit(conn, parked.ordered, parked.continuation)) return;
+        conn.parked.pop_front();
+    }
+
+    while ((conn.ordered_in_flight ? 1 : 0) + conn.unordered_in_flight < max_in_flight) {
+        // 지금 처리할 수 있는 첫 프레임: 순서 무관 요청이거나, 처리 중인 순서 보장 요청이 없을 때의 첫 순서 보장 요청
+        auto next = conn.pending_frames.begin();
+        while (next != conn.pending_frames.end() && next->ordered && conn.ordered_in_flight) ++next;
+        if (next == conn.pending_frames.end()) return;
+
+        bool ordered = next->ordered;
+        auto frame = make_shared<vector<char>>(move(next->data));
+        if (!submit(conn, ordered, [this, frame](ResponseWriter& writer) { on_frame(move(*frame), writer); })) {
+            next->data = move(*frame);
+            return;
+        }
+
+        conn.pending_frames.erase(next);
+        if (ordered) {
+            conn.ordered_in_flight = true;
+        } else {
+            conn.unordered_in_flight++;
+        }
+    }
+}
+
+// 요청 처리 작업 하나를 워커 풀에 제출, 대기열이 가득 차면 연결을 starved 로 표시하고 false
+bool EventLoop::submit(Connection& conn, bool ordered, Continuation job) {
+    uint64_t id = conn.id;
+    auto flow = conn.flow;
+    auto options = conn.options;
+    bool submitted = pool.try_submit([this, id, ordered, flow, options, job]() {
+        ResponseWriter writer(this, id, flow, options);
+        try {
+            job(writer);
+        } catch (const exception& e) {
+            LOG_ERROR("[Conn " << id << "] 요청 처리 중 예외 발생: " << e.what());
+        }
+        // 나머지 처리를 미뤘으면 요청은 아직 끝나지 않음
+        bool done = !writer.deferred;
+        post(Completion{id, string(), 0, done, ordered, move(writer.deferred)});
+    });
+
+    if (!submitted) {
+        conn.starved = true;
+        starved_connections.push_back(id);
+    }
+    return submitted;
+}
+
+void EventLoop::retry_starved() {
+    while (!starved_connections.empty()) {
+        uint64_t id = starved_connections.front();
+        starved_connections.pop_front();
+
+        auto it = connections.find(id);
+        if (it == connections.end()) continue;
+
+        Connection& conn = *it->second;
+        conn.starved = false;
+        schedule(conn);
+        if (conn.starved) {
+            // 여전히 대기열이 가득 참: 순서를 유지한 채 다음 완료 때 다시 시도
+            starved_connections.pop_back();
+            starved_connections.push_front(id);
+            return;
+        }
+    }
+}
+
+/*
+
+소켓 이벤트 처리
+
+*/
+
+void EventLoop::accept_clients() {
+    while (true) {
+        int client_fd = accept4(server_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            LOG_ERROR("연결 수락 실패: " << strerror(errno));
+            return;
+        }
+
+        SSL* ssl = SSL_new(ssl_ctx);
+        if (!ssl) {
+            ERR_print_errors_fp(stderr);
+            close(client_fd);
+            continue;
+        }
+        SSL_set_fd(ssl, client_fd);
+        SSL_set_accept_state(ssl);
+        // 부분 송신 허용: 큰 응답도 소켓이 받아주는 만큼씩 나눠서 보냄
+        SSL_set_mode(ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+        auto conn = make_unique<Connection>();
+        conn->id = next_connection_id++;
+        conn->fd = client_fd;
+        conn->ssl = ssl;
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u64 = conn->id;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+            LOG_ERROR("epoll 등록 실패: " << strerror(errno));
+            SSL_free(ssl);
+            close(client_fd);
+            continue;
+        }
+        conn->epoll_events = EPOLLIN;
+
+        LOG_INFO("[Conn " << conn->id << "] 클라이언트 연결 수락됨. SSL 핸드셰이크 대기...");
+
+        connections[conn->id] = move(conn);
+    }
+}
+
+bool EventLoop::handle_event(Connection& conn, uint32_t events) {
+    if ((events & (EPOLLERR | EPOLLHUP)) && !(events & EPOLLIN)) {
+        return false;
+    }
+
+    if (!conn.handshake_done) {
+        if (!do_handshake(conn)) return false;
+        if (!conn.handshake_done) return true;
+        // 핸드셰이크 직후 이미 도착해 있는 데이터가 있을 수 있으므로 바로 읽기 시도
+        events |= EPOLLIN;
+    }
+
+    bool readable = (events & EPOLLIN) || ((events & EPOLLOUT) && conn.read_wants_write);
+    bool writable = (events & EPOLLOUT) || ((events & EPOLLIN) && conn.write_wants_read);
+
+    if (readable) {
+        if (!do_read(conn)) return false;
+    }
+    if (writable || !conn.write_buffer.empty()) {
+        if (!flush(conn)) return false;
+        // 송신 대기량이 줄었으면 미뤄 둔 요청과 대기 프레임 처리 재개
+        schedule(conn);
+    }
+    return true;
+}
+
+// 핸드셰이크 후 송신 레코드 암호화가 커널(kTLS)로 넘어갔는지 확인
+static bool ktls_send_enabled(SSL* ssl) {
+#if defined(SSL_OP_ENABLE_KTLS) && defined(BIO_get_ktls_send)
+    return BIO_get_ktls_send(SSL_get_wbio(ssl));
+#else
+    (void)ssl;
+    return false;
+#endif
+}
+
+bool EventLoop::do_handshake(Connection& conn) {
+    conn.handshake_wants_write = false;
+    int ret = SSL_do_handshake(conn.ssl);
+    if (ret == 1) {
+        conn.handshake_done = true;
+        LOG_INFO("[Conn " << conn.id << "] SSL 클라이언트 처리 시작. (세션 재사용: "
+                 << (SSL_session_reused(conn.ssl) ? "O" : "X") << ", kTLS 송신: "
+                 << (ktls_send_enabled(conn.ssl) ? "O" : "X") << ")");
+        if (on_open) on_open(conn);
+        return true;
+    }
+
+    int error = SSL_get_error(conn.ssl, ret);
+    if (error == SSL_ERROR_WANT_READ) return true;
+    if (error == SSL_ERROR_WANT_WRITE) {
+        conn.handshake_wants_write = true;
+        return true;
+    }
+    ERR_print_errors_fp(stderr);
+    conn.ssl_failed = true;
+    return false;
+}
+
+bool EventLoop::do_read(Connection& conn) {
+    conn.read_wants_write = false;
+    char buffer[READ_CHUNK_SIZE];
+
+    // 처리 대기 프레임이 많으면 더 읽지 않음 (요청 처리가 따라잡으면 drain_completions 에서 재개)
+    while (conn.pending_frames.size() < MAX_PENDING_FRAMES) {
+        int bytes_received = SSL_read(conn.ssl, buffer, sizeof(buffer));
+        if (bytes_received > 0) {
+            conn.read_buffer.insert(conn.read_buffer.end(), buffer, buffer + bytes_received);
+            if (!dispatch_frames(conn)) return false;
+            continue;
+        }
+
+        int error = SSL_get_error(conn.ssl, bytes_received);
+        if (error == SSL_ERROR_WANT_READ) break;
+        if (error == SSL_ERROR_WANT_WRITE) {
+            conn.read_wants_write = true;
+            break;
+        }
+        if (error != SSL_ERROR_ZERO_RETURN) {
+            ERR_print_errors_fp(stderr);
+            conn.ssl_failed = true;
+        }
+        // 클라이언트가 연결을 끊음
+        return false;
+    }
+
+    return dispatch_frames(conn);
+}
+
+bool EventLoop::dispatch_frames(Connection& conn) {
+    while (conn.pending_frames.size() < MAX_PENDING_FRAMES &&
+           conn.read_buffer.size() - conn.read_offset >= sizeof(uint32_t)) {
+        uint32_t net_len;
+        memcpy(&net_len, conn.read_buffer.data() + conn.read_offset, sizeof(net_len));
+        uint32_t json_len = ntohl(net_len);
+        if (json_len == 0 || json_len > MAX_FRAME_SIZE) {
+            LOG_WARN("[Conn " << conn.id << "] 비정상적인 데이터 길이 수신: " << json_len);
+            return false;
+        }
+
+        if (conn.read_buffer.size() - conn.read_offset < sizeof(net_len) + json_len) break;
+
+        auto frame_begin = conn.read_buffer.begin() + conn.read_offset + sizeof(net_len);
+        PendingFrame frame{vector<char>(frame_begin, frame_begin + json_len), true};
+        if (is_unordered) frame.ordered = !is_unordered(frame.data);
+        conn.pending_frames.push_back(move(frame));
+        conn.read_offset += sizeof(net_len) + json_len;
+    }
+
+    // 처리된 앞부분 제거
+    if (conn.read_offset > 0) {
+        conn.read_buffer.erase(conn.read_buffer.begin(), conn.read_buffer.begin() + conn.read_offset);
+        conn.read_offset = 0;
+    }
+
+    schedule(conn);
+    return true;
+}
+
+// 본문 크기는 ResponseWriter::send_frame 에서 BINARY_FRAME_FLAG 미만으로 확인됨
+void EventLoop::send_frame(Connection& conn, const string& payload, uint32_t flags) {
+    uint32_t net_res_len = htonl(static_cast<uint32_t>(payload.size()) | flags);
+    conn.write_buffer.append(reinterpret_cast<const char*>(&net_res_len), sizeof(net_res_len));
+    conn.write_buffer.append(payload);
+}
+
+bool EventLoop::flush(Connection& conn) {
+    conn.write_wants_read = false;
+    size_t flushed = 0;
+    bool ok = true;
+
+    while (conn.write_offset < conn.write_buffer.size()) {
+        size_t remaining = conn.write_buffer.size() - conn.write_offset;
+        int bytes_sent = SSL_write(conn.ssl, conn.write_buffer.data() + conn.write_offset,
+                                   static_cast<int>(min(remaining, static_cast<size_t>(INT_MAX))));
+        if (bytes_sent > 0) {
+            conn.write_offset += bytes_sent;
+            flushed += bytes_sent;
+            continue;
+        }
+
+        int error = SSL_get_error(conn.ssl, bytes_sent);
+        if (error == SSL_ERROR_WANT_READ) {
+            conn.write_wants_read = true;
+        } else if (error != SSL_ERROR_WANT_WRITE) {
+            ERR_print_errors_fp(stderr);
+            conn.ssl_failed = true;
+            ok = false;
+        }
+        break;
+    }
+
+    if (conn.write_offset >= conn.write_buffer.size()) {
+        conn.write_buffer.clear();
+        conn.write_offset = 0;
+    } else if (conn.write_offset >= SEND_HIGH_WATER_MARK) {
+        // 이미 보낸 앞부분이 커지면 정리해 버퍼가 계속 자라지 않게 함
+        conn.write_buffer.erase(0, conn.write_offset);
+        conn.write_offset = 0;
+    }
+
+    // 워커가 보낸 바이트가 소켓으로 나간 만큼 흐름 제어 예약 해제 (버퍼 앞쪽부터 순서대로 송신됨)
+    size_t released = min(flushed, conn.flow_bytes_pending);
+    if (released > 0) {
+        conn.flow_bytes_pending -= released;
+        conn.flow->release(released);
+    }
+    return ok;
+}
+
+void EventLoop::update_interest(Connection& conn) {
+    uint32_t desired = 0;
+    if (conn.pending_frames.size() < MAX_PENDING_FRAMES || conn.write_wants_read) {
+        desired |= EPOLLIN;
+    }
+    if (conn.handshake_wants_write || conn.read_wants_write ||
+        conn.write_offset < conn.write_buffer.size()) {
+        desired |= EPOLLOUT;
+    }
+    if (desired == conn.epoll_events) return;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = desired;
+    ev.data.u64 = conn.id;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev) == 0) {
+        conn.epoll_events = desired;
+    }
+}
+
+void EventLoop::close_connection(uint64_t connection_id) {
+    auto it = connections.find(connection_id);
+    if (it == connections.end()) return;
+
+    Connection& conn = *it->second;
+    conn.flow->close(); // 송신 대기 중인 워커를 깨워 스트리밍 응답 중단
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn.fd, nullptr);
+    if (conn.handshake_done && !conn.ssl_failed) {
+        SSL_shutdown(conn.ssl); // 논블로킹이므로 close_notify 송신만 시도
+    }
+    ERR_clear_error();
+    SSL_free(conn.ssl);
+    close(conn.fd);
+
+    LOG_INFO("[Conn " << conn.id << "] 클라이언트 연결 종료 및 정리.");
+
+    connections.erase(it);
+}
@@ -0,0 +1,214 @@
+// epoll 기반 TLS 이벤트 루프 모듈
+// 클라이언트마다 스레드를 만들지 않고, 하나의 epoll 루프에서 논블로킹 SSL 핸드셰이크와
+// 길이(4바이트 빅엔디언) + JSON 프레임 송수신을 처리한다.
+// 완성된 프레임은 워커 풀에서 처리되고, 응답은 eventfd 를 통해 다시 이벤트 루프로 전달된다.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+// OpenSSL 관련 헤더
+#include <openssl/ssl.h>
+
+#include "worker_pool.hpp"
+
+using namespace std;
+
+// 연결당 동시에 워커에서 처리할 수 있는 요청 수 (correlation id 가 있는 요청끼리는 순서와 무관하게 병렬 처리)
+// 실제 상한은 워커 수 - 1 이하로 줄여, 한 연결이 워커를 모두 차지해 다른 연결의 요청이 밀리지 않게 함
+const size_t MAX_IN_FLIGHT_PER_CONNECTION = 4;
+
+// 수신 프레임 최대 길이 (비정상 길이 값으로 인한 메모리 고갈 방지)
+const uint32_t MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+// 연결당 처리 대기 프레임 최대 개수 (초과 시 해당 연결의 수신을 잠시 멈춤)
+const size_t MAX_PENDING_FRAMES = 8;
+
+// 바이너리 프레임 표시: 길이 헤더의 최상위 비트가 1 이면 본문이 [4바이트 JSON 헤더 길이][JSON 헤더][원본 바이트] 형식
+// (request_id 8 로 협상한 연결에만 사용하므로 기존 클라이언트는 항상 JSON 프레임만 받음)
+const uint32_t BINARY_FRAME_FLAG = 0x80000000;
+
+// 연결당 송신 대기 바이트 상한
+// 넘으면 그 연결의 새 요청은 처리를 미루고, 스트리밍 응답은 멈췄다가 소켓으로 빠져나간 뒤 이어서 보냄 (워커는 기다리지 않음)
+const size_t SEND_HIGH_WATER_MARK = 1 * 1024 * 1024;
+
+// 워커와 이벤트 루프가 공유하는 연결별 송신 흐름 제어 상태
+// 워커가 보낸 응답 중 아직 소켓으로 나가지 못한 바이트 수를 추적한다.
+struct FlowControl {
+    mutex flow_mutex;
+    size_t queued_bytes = 0;
+    bool closed = false;
+
+    // 송신 대기량에 bytes 를 더함 (기다리지 않음, 연결이 끊겼으면 false)
+    bool reserve(size_t bytes);
+    // 소켓으로 송신 완료된 bytes 만큼 예약 해제
+    void release(size_t bytes);
+    // 송신 대기량이 SEND_HIGH_WATER_MARK 이상인지
+    bool congested();
+    void close();
+};
+
+class ResponseWriter;
+
+// 송신 대기로 미뤘다가 워커에서 이어서 실행할 요청의 나머지 처리
+using Continuation = function<void(ResponseWriter&)>;
+
+// 연결별로 협상된 프로토콜 옵션 (워커 스레드에서 읽고 씀)
+struct ConnectionOptions {
+    atomic<bool> binary_frames{false}; // 이미지 응답을 바이너리 프레임으로 전송
+};
+
+// 워커에 넘기기 전 대기 중인 요청 프레임
+struct PendingFrame {
+    vector<char> data;
+    bool ordered;                    // true 이면 같은 연결의 다른 순서 보장 요청이 끝난 뒤에 처리
+};
+
+// 송신 대기량이 줄기를 기다리는 요청 (처리 중인 요청 수에 계속 포함됨)
+struct ParkedRequest {
+    Continuation continuation;
+    bool ordered;
+};
+
+// 클라이언트 연결 하나의 상태
+struct Connection {
+    uint64_t id = 0;
+    int fd = -1;
+    SSL* ssl = nullptr;
+
+    bool handshake_done = false;
+    bool ssl_failed = false;         // 치명적 SSL 오류 발생 (SSL_shutdown 생략)
+    bool handshake_wants_write = false;
+    bool read_wants_write = false;   // SSL_read 가 WANT_WRITE 를 반환한 상태
+    bool write_wants_read = false;   // SSL_write 가 WANT_READ 를 반환한 상태
+
+    vector<char> read_buffer;        // 아직 프레임으로 완성되지 않은 수신 데이터
+    size_t read_offset = 0;
+    string write_buffer;             // 송신 대기 중인 프레임들
+    size_t write_offset = 0;
+
+    deque<PendingFrame> pending_frames; // 워커에 넘기기 전 대기 중인 요청 프레임
+    deque<ParkedRequest> parked;     // 송신 대기량이 줄면 다시 워커에 넘길 요청
+    bool ordered_in_flight = false;  // 순서 보장 요청이 워커에서 처리 중 (순서 보장 요청은 하나씩 처리해 응답 순서 유지)
+    size_t unordered_in_flight = 0;  // 워커에서 처리 중인 순서 무관 요청 수
+    bool starved = false;            // 워커 풀 대기열이 가득 차 제출을 기다리는 중
+    shared_ptr<FlowControl> flow = make_shared<FlowControl>();
+    shared_ptr<ConnectionOptions> options = make_shared<ConnectionOptions>();
+    size_t flow_bytes_pending = 0;   // write_buffer 중 워커가 보낸(흐름 제어 대상) 바이트 수
+
+    uint32_t epoll_events = 0;       // 현재 epoll 에 등록된 관심 이벤트
+};
+
+class EventLoop;
+
+// 워커 스레드에서 응답 프레임을 이벤트 루프로 돌려보내는 핸들
+// 연결이 이미 끊어진 경우 송신 요청은 무시된다.
+class ResponseWriter {
+public:
+    ResponseWriter(EventLoop* loop, uint64_t connection_id, shared_ptr<FlowControl> flow, shared_ptr<ConnectionOptions> options)
+        : loop(loop), connection_id(connection_id), flow(move(flow)), options(move(options)) {}
+
+    // 응답 프레임 송신 요청 (기다리지 않고 이벤트 루프로 넘김)
+    // 연결이 이미 끊어졌으면 false 반환 (스트리밍 응답은 이때 중단하면 됨)
+    // 본문이 길이 헤더에 담기지 않을 만큼(BINARY_FRAME_FLAG 바이트 이상) 크면 length_error
+    bool send(string payload);
+    // 바이너리 프레임 송신 요청 (payload 는 BINARY_FRAME_FLAG 형식의 본문)
+    bool send_binary(string payload);
+
+    // 송신 대기량이 SEND_HIGH_WATER_MARK 이상인지 (스트리밍 응답은 이때 멈추고 defer 로 나머지를 맡김)
+    bool congested() const { return flow->congested(); }
+    // 요청의 나머지 처리를 맡김: 이 워커 작업이 끝나면 이벤트 루프가 보관했다가 송신 대기량이 줄면 워커에서 실행
+    void defer(Continuation continuation) { deferred = move(continuation); }
+
+    uint64_t id() const { return connection_id; }
+    ConnectionOptions& connection_options() { return *options; }
+    // 이 writer 로 송신 요청한 바이트 수 (길이 헤더 포함)
+    size_t bytes_sent() const { return sent_bytes; }
+
+private:
+    EventLoop* loop;
+    uint64_t connection_id;
+    shared_ptr<FlowControl> flow;
+    shared_ptr<ConnectionOptions> options;
+    size_t sent_bytes = 0;
+    Continuation deferred;
+
+    bool send_frame(string payload, uint32_t flags);
+
+    friend class EventLoop;
+};
+
+class EventLoop {
+public:
+    // 완성된 프레임(길이 헤더 제외)을 처리하는 콜백, 워커 스레드에서 실행됨
+    using FrameHandler = function<void(vector<char>&&, ResponseWriter&)>;
+    // SSL 핸드셰이크가 끝난 연결을 알리는 콜백, 이벤트 루프 스레드에서 실행됨
+    using OpenHandler = function<void(Connection&)>;
+    // 프레임을 앞선 요청의 응답을 기다리지 않고 바로 처리해도 되는지 판단, 이벤트 루프 스레드에서 실행됨
+    // (설정하지 않으면 모든 프레임을 수신 순서대로 하나씩 처리)
+    using FrameClassifier = function<bool(const vector<char>&)>;
+
+    EventLoop(SSL_CTX* ctx, WorkerPool& pool, FrameHandler on_frame);
+    ~EventLoop();
+
+    void set_open_handler(OpenHandler on_open);
+    void set_frame_classifier(FrameClassifier is_unordered);
+
+    bool listen_on(int port);
+    void run();
+
+    // 임의의 스레드에서 호출 가능: 응답 프레임을 이벤트 루프로 전달
+    void post_frame(uint64_t connection_id, string payload, uint32_t flags = 0);
+
+private:
+    // 워커 → 이벤트 루프로 전달되는 항목
+    struct Completion {
+        uint64_t connection_id;
+        string payload;
+        uint32_t flags;              // 길이 헤더에 함께 실을 프레임 종류 비트 (BINARY_FRAME_FLAG)
+        bool request_done;           // true 이면 해당 연결의 요청 처리가 끝났음을 의미
+        bool ordered;                // 처리가 끝난(또는 미뤄진) 요청이 순서 보장 요청인지 여부
+        Continuation continuation;   // 요청이 나머지 처리를 미뤘으면 송신 대기량이 줄었을 때 실행할 작업
+    };
+
+    SSL_CTX* ssl_ctx;
+    WorkerPool& pool;
+    FrameHandler on_frame;
+    OpenHandler on_open;
+    FrameClassifier is_unordered;
+    const size_t max_in_flight;      // 연결당 동시 처리 요청 수 (MAX_IN_FLIGHT_PER_CONNECTION 과 워커 수 - 1 중 작은 값, 최소 1)
+
+    int epoll_fd = -1;
+    int server_fd = -1;
+    int wakeup_fd = -1;              // 워커가 완료를 알릴 때 사용하는 eventfd
+    uint64_t next_connection_id = 1;
+    unordered_map<uint64_t, unique_ptr<Connection>> connections;
+    deque<uint64_t> starved_connections;
+
+    mutex completions_mutex;
+    vector<Completion> completions;
+
+    void post(Completion completion);
+    void drain_completions();
+    void schedule(Connection& conn);
+    bool submit(Connection& conn, bool ordered, Continuation job);
+    void retry_starved();
+
+    void accept_clients();
+    bool handle_event(Connection& conn, uint32_t events);
+    bool do_handshake(Connection& conn);
+    bool do_read(Connection& conn);
+    bool dispatch_frames(Connection& conn);
+    void send_frame(Connection& conn, const string& payload, uint32_t flags);
+    bool flush(Connection& conn);
+    void update_interest(Connection& conn);
+    void close_connection(uint64_t connection_id);
+};
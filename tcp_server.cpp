@@ -1,4 +1,6 @@
 #include "tcp_server.hpp" 
+#include "config_cache.hpp"
+#include "logger.hpp"
 
 /*
 
@@ -31,6 +33,103 @@ SSL_CTX* create_ssl_context() {
     return ctx;
 }
 
+// 세션 티켓 암호화 키 (앞쪽이 현재 키, 뒤쪽은 이전 키로 복호화에만 사용)
+struct TicketKey {
+    unsigned char name[16];
+    unsigned char aes_key[32];
+    unsigned char hmac_key[32];
+    chrono::steady_clock::time_point created;
+};
+
+static deque<TicketKey> ticket_keys;
+static mutex ticket_keys_mutex;
+
+// 현재 키가 없거나 교체 주기가 지났으면 새 키를 만들어 앞에 추가 (ticket_keys_mutex 잠금 상태에서 호출)
+static bool rotate_ticket_keys() {
+    auto now = chrono::steady_clock::now();
+    if (!ticket_keys.empty() && now - ticket_keys.front().created < TICKET_KEY_ROTATION_INTERVAL) return true;
+
+    TicketKey key;
+    if (RAND_bytes(key.name, sizeof(key.name)) <= 0 ||
+        RAND_bytes(key.aes_key, sizeof(key.aes_key)) <= 0 ||
+        RAND_bytes(key.hmac_key, sizeof(key.hmac_key)) <= 0) {
+        return !ticket_keys.empty();
+    }
+    key.created = now;
+    ticket_keys.push_front(key);
+    while (ticket_keys.size() > TICKET_KEY_COUNT) ticket_keys.pop_back();
+    return true;
+}
+
+// 티켓 발급(enc=1)에는 현재 키를, 복호화(enc=0)에는 이름이 일치하는 키를 찾아 cipher 초기화
+// 반환값: 1 = 사용, 2 = 사용하되 새 키로 티켓 재발급, 0 = 알 수 없는 키(전체 핸드셰이크), -1 = 오류
+static const TicketKey* select_ticket_key(unsigned char key_name[16], unsigned char* iv, EVP_CIPHER_CTX* cipher_ctx, int enc, int& result) {
+    if (!rotate_ticket_keys()) {
+        result = -1;
+        return nullptr;
+    }
+
+    if (enc) {
+        const TicketKey& key = ticket_keys.front();
+        if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) <= 0 ||
+            !EVP_EncryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), nullptr, key.aes_key, iv)) {
+            result = -1;
+            return nullptr;
+        }
+        memcpy(key_name, key.name, sizeof(key.name));
+        result = 1;
+        return &key;
+    }
+
+    for (size_t i = 0; i < ticket_keys.size(); i++) {
+        const TicketKey& key = ticket_keys[i];
+        if (memcmp(key_name, key.name, sizeof(key.name)) != 0) continue;
+        if (!EVP_DecryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), nullptr, key.aes_key, iv)) {
+            result = -1;
+            return nullptr;
+        }
+        result = i == 0 ? 1 : 2;
+        return &key;
+    }
+    result = 0;
+    return nullptr;
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+static int ticket_key_callback(SSL*, unsigned char key_name[16], unsigned char* iv,
+                               EVP_CIPHER_CTX* cipher_ctx, EVP_MAC_CTX* mac_ctx, int enc) {
+    lock_guard<mutex> lock(ticket_keys_mutex);
+    int result = 0;
+    const TicketKey* key = select_ticket_key(key_name, iv, cipher_ctx, enc, result);
+    if (!key) return result;
+
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, const_cast<unsigned char*>(key->hmac_key), sizeof(key->hmac_key)),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0),
+        OSSL_PARAM_construct_end()
+    };
+    if (!EVP_MAC_CTX_set_params(mac_ctx, params)) return -1;
+    return result;
+}
+#else
+static int ticket_key_callback(SSL*, unsigned char key_name[16], unsigned char* iv,
+                               EVP_CIPHER_CTX* cipher_ctx, HMAC_CTX* hmac_ctx, int enc) {
+    lock_guard<mutex> lock(ticket_keys_mutex);
+    int result = 0;
+    const TicketKey* key = select_ticket_key(key_name, iv, cipher_ctx, enc, result);
+    if (!key) return result;
+
+    if (!HMAC_Init_ex(hmac_ctx, key->hmac_key, sizeof(key->hmac_key), EVP_sha256(), nullptr)) return -1;
+    return result;
+}
+#endif
+
+// 환경변수 TLS_KTLS=1 이면 핸드셰이크 후 레코드 암호화를 커널(kTLS)에 맡김
+static bool ktls_requested() {
+    const char* value = getenv("TLS_KTLS");
+    return value && strcmp(value, "1") == 0;
+}
+
 // SSL 컨텍스트 설정
 void configure_ssl_context(SSL_CTX* ctx) {
     if (SSL_CTX_use_certificate_file(ctx, "fullchain.crt", SSL_FILETYPE_PEM) <= 0) {
@@ -42,6 +141,32 @@ void configure_ssl_context(SSL_CTX* ctx) {
         ERR_print_errors_fp(stderr);
         exit(EXIT_FAILURE);
     }
+
+    // 재접속 클라이언트가 전체 핸드셰이크 없이 세션을 재사용하도록 서버 세션 캐시 사용
+    SSL_CTX_set_session_id_context(ctx, reinterpret_cast<const unsigned char*>(TLS_SESSION_ID_CONTEXT), strlen(TLS_SESSION_ID_CONTEXT));
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, TLS_SESSION_CACHE_SIZE);
+    SSL_CTX_set_timeout(ctx, TLS_SESSION_TIMEOUT);
+
+    // 세션 티켓은 주기적으로 교체되는 키로 암호화 (이전 키로 발급된 티켓은 받아주되 새 키로 재발급)
+    {
+        lock_guard<mutex> lock(ticket_keys_mutex);
+        rotate_ticket_keys();
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, ticket_key_callback);
+#else
+    SSL_CTX_set_tlsext_ticket_key_cb(ctx, ticket_key_callback);
+#endif
+
+    if (ktls_requested()) {
+#ifdef SSL_OP_ENABLE_KTLS
+        SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+        LOG_INFO("kTLS 모드 사용 (커널 지원 시 핸드셰이크 후 송수신 암호화를 커널에서 처리)");
+#else
+        LOG_WARN("이 OpenSSL 버전은 kTLS 를 지원하지 않아 사용자 공간 암호화로 동작합니다.");
+#endif
+    }
 }
 
 /*
@@ -74,7 +199,7 @@ string getLines(){
         // 각 통신 요청마다 이 핸들을 생성하고 설정해요.
         curl_handle = curl_easy_init();
         if (!curl_handle) {
-            std::cerr << "curl_easy_init() 실패" << std::endl;
+            LOG_ERROR("curl_easy_init() 실패");
             curl_global_cleanup();
             return NULL;
         }
@@ -128,16 +253,13 @@ string getLines(){
 
         // 4. 결과 확인
         if (res_perform != CURLE_OK) {
-            std::cerr << "curl_easy_perform() 실패: " << curl_easy_strerror(res_perform) << std::endl;
+            LOG_ERROR("curl_easy_perform() 실패: " << curl_easy_strerror(res_perform));
         } else {
             long http_code = 0;
             curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &http_code); // HTTP 응답 코드 얻기
             
-            std::cout << "--- HTTP 응답 수신 ---" << std::endl;
-            std::cout << "HTTP Status Code: " << http_code << std::endl;
-            std::cout << "--- 응답 본문 ---" << std::endl;
-            std::cout << response_buffer << std::endl;
-            std::cout << "------------------" << std::endl;
+            LOG_INFO("HTTP 응답 수신 (Status Code: " << http_code << ")");
+            LOG_DEBUG("HTTP 응답 본문:\n" << response_buffer);
         }
 
         // 5. 자원 해제
@@ -146,7 +268,7 @@ string getLines(){
 
     } catch (const std::exception& e) {
         // 예외 처리 (예: new 실패 등)
-        std::cerr << "예외 발생: " << e.what() << std::endl;
+        LOG_ERROR("예외 발생: " << e.what());
     }
     return response_buffer;
 }
@@ -160,7 +282,7 @@ string putLines(CrossLine crossLine){
         // 각 통신 요청마다 이 핸들을 생성하고 설정해요.
         curl_handle = curl_easy_init();
         if (!curl_handle) {
-            std::cerr << "curl_easy_init() 실패" << std::endl;
+            LOG_ERROR("curl_easy_init() 실패");
             curl_global_cleanup();
             return NULL;
         }
@@ -211,7 +333,7 @@ string putLines(CrossLine crossLine){
         curlRoot["line"] = lineArray;
 
         string insert_json_string = curlRoot.dump();
-        cout << "--- HTTP Payload 원문 ---\n" << insert_json_string << "\n"; 
+        LOG_DEBUG("HTTP Payload 원문:\n" << insert_json_string);
         
         curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, insert_json_string.c_str()); // 데이터 포인터
         curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE, insert_json_string.length()); // 데이터 길이
@@ -248,16 +370,13 @@ string putLines(CrossLine crossLine){
 
         // 4. 결과 확인
         if (res_perform != CURLE_OK) {
-            std::cerr << "curl_easy_perform() 실패: " << curl_easy_strerror(res_perform) << std::endl;
+            LOG_ERROR("curl_easy_perform() 실패: " << curl_easy_strerror(res_perform));
         } else {
             long http_code = 0;
             curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &http_code); // HTTP 응답 코드 얻기
             
-            std::cout << "--- HTTP 응답 수신 ---" << std::endl;
-            std::cout << "HTTP Status Code: " << http_code << std::endl;
-            std::cout << "--- 응답 본문 ---" << std::endl;
-            std::cout << response_buffer << std::endl;
-            std::cout << "------------------" << std::endl;
+            LOG_INFO("HTTP 응답 수신 (Status Code: " << http_code << ")");
+            LOG_DEBUG("HTTP 응답 본문:\n" << response_buffer);
         }
 
         // 5. 자원 해제
@@ -266,7 +385,7 @@ string putLines(CrossLine crossLine){
 
     } catch (const std::exception& e) {
         // 예외 처리 (예: new 실패 등)
-        std::cerr << "예외 발생: " << e.what() << std::endl;
+        LOG_ERROR("예외 발생: " << e.what());
     }
 
     return response_buffer;
@@ -281,7 +400,7 @@ string deleteLines(int index){
         // 각 통신 요청마다 이 핸들을 생성하고 설정해요.
         curl_handle = curl_easy_init();
         if (!curl_handle) {
-            std::cerr << "curl_easy_init() 실패" << std::endl;
+            LOG_ERROR("curl_easy_init() 실패");
             curl_global_cleanup();
             return NULL;
         }
@@ -331,16 +450,13 @@ string deleteLines(int index){
 
         // 4. 결과 확인
         if (res_perform != CURLE_OK) {
-            std::cerr << "curl_easy_perform() 실패: " << curl_easy_strerror(res_perform) << std::endl;
+            LOG_ERROR("curl_easy_perform() 실패: " << curl_easy_strerror(res_perform));
         } else {
             long http_code = 0;
             curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &http_code); // HTTP 응답 코드 얻기
             
-            std::cout << "--- HTTP 응답 수신 ---" << std::endl;
-            std::cout << "HTTP Status Code: " << http_code << std::endl;
-            std::cout << "--- 응답 본문 ---" << std::endl;
-            std::cout << response_buffer << std::endl;
-            std::cout << "------------------" << std::endl;
+            LOG_INFO("HTTP 응답 수신 (Status Code: " << http_code << ")");
+            LOG_DEBUG("HTTP 응답 본문:\n" << response_buffer);
         }
 
         // 5. 자원 해제
@@ -349,411 +465,72 @@ string deleteLines(int index){
 
     } catch (const std::exception& e) {
         // 예외 처리 (예: new 실패 등)
-        std::cerr << "예외 발생: " << e.what() << std::endl;
+        LOG_ERROR("예외 발생: " << e.what());
     }
 
     return response_buffer;
 }
 
-string base64_encode(const vector<unsigned char>& in) {
-    string out;
-    const string b64_chars =
-                 "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                 "abcdefghijklmnopqrstuvwxyz"
-                 "0123456789+/";
-
-    int val = 0, valb = -6;
-    for (unsigned char c : in) {
-        val = (val << 8) + c;
-        valb += 8;
-        while (valb >= 0) {
-            out.push_back(b64_chars[(val >> valb) & 0x3F]);
-            valb -= 6;
-        }
-    }
-    if (valb > -6) out.push_back(b64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
-    while (out.size() % 4) out.push_back('=');
-    return out;
-}
-
-// --- 클라이언트 처리 스레드 함수 ---
-void handle_client(int client_socket, SQLite::Database& db, std::mutex& db_mutex) {
-    // SSL 연결 설정
-    SSL* ssl = SSL_new(ssl_ctx);
-    if (!ssl) {
-        ERR_print_errors_fp(stderr);
-        close(client_socket);
-        return;
-    }
-
-    SSL_set_fd(ssl, client_socket);
-    if (SSL_accept(ssl) <= 0) {
-        ERR_print_errors_fp(stderr);
-        SSL_free(ssl);
-        close(client_socket);
-        return;
-    }
-
-    printNowTimeKST();
-    cout << " [Thread " << std::this_thread::get_id() << "] SSL 클라이언트 처리 시작." << endl;
-
-    create_table_detections(db);
-    create_table_lines(db);
-    create_table_baseLines(db);
-    create_table_verticalLineEquations(db);
-   
-
-    while (true) {
-        uint32_t net_len;
-        if (!recvAll(ssl, reinterpret_cast<char*>(&net_len), sizeof(net_len))) {
-            break; 
-        }
-
-        uint32_t json_len = ntohl(net_len);
-        if (json_len == 0) {
-            cerr << "[Thread " << std::this_thread::get_id() << "] 비정상적인 데이터 길이 수신: " << json_len << endl;
-            break;
-        }
-
-        vector<char> json_buffer(json_len);
-        if (!recvAll(ssl, json_buffer.data(), json_len)) {
-            break;
-        }
-
-        try {
-            json received_json = json::parse(json_buffer);
-            printNowTimeKST();
-            cout << " [Thread " << std::this_thread::get_id() << "] 수신 성공:\n" << received_json.dump(2) << endl;
-
-            string json_string;
-            if (received_json.value("request_id", -1) == 1) {
-                // 클라이언트의 이미지&텍스트 요청(select) 신호
-                string start_ts = received_json["data"].value("start_timestamp", "");
-                string end_ts = received_json["data"].value("end_timestamp", "");
-                
-                vector<Detection> detections;
-                // --- DB 접근 시 Mutex로 보호 ---
-                {
-                    std::lock_guard<std::mutex> lock(db_mutex);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 조회 시작 (Lock 획득)" << endl;
-                    detections = select_data_for_timestamp_range_detections(db, start_ts, end_ts);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 조회 완료 (Lock 해제)" << endl;
-                }
-                // --- 보호 끝 ---
-
-                json root;
-                root["request_id"] = 10;
-                json data_array = json::array();
-                for (const auto& detection : detections) {
-                    json d_obj;
-                    d_obj["image"] = base64_encode(detection.imageBlob);
-                    d_obj["timestamp"] = detection.timestamp;
-                    data_array.push_back(d_obj);
-                }
-                root["data"] = data_array;
-                json_string = root.dump();
-                
-                uint32_t res_len = json_string.length();
-                uint32_t net_res_len = htonl(res_len);
-                sendAll(ssl, reinterpret_cast<const char*>(&net_res_len), sizeof(net_res_len), 0);
-                sendAll(ssl, json_string.c_str(), res_len, 0);
-                
-                cout << "[Thread " << std::this_thread::get_id() << "] 응답 전송 완료." << endl;
-            } 
-            
-            else if(received_json.value("request_id", 2) == 2){
-                // 클라이언트의 가상 라인 좌표값 - 도트 매트릭스 매핑 요청(insert) 신호
-
-                int index = received_json["data"].value("index", -1);
-                int x1 = received_json["data"].value("x1", -1);
-                int y1 = received_json["data"].value("y1", -1);
-                int x2 = received_json["data"].value("x2", -1);
-                int y2 = received_json["data"].value("y2", -1);
-                string name = received_json["data"].value("name", "name1");
-                string mode = received_json["data"].value("mode", "BothDirections");
-                int leftMatrixNum = received_json["data"].value("leftMatrixNum", -1);
-                int rightMatrixNum = received_json["data"].value("rightMatrixNum", -1);
-
-                CrossLine newCrossLine = {index, x1*4, y1*4, x2*4, y2*4, name, mode, leftMatrixNum, rightMatrixNum};
-
-                putLines(newCrossLine);
-
-                bool mappingSuccess;
-                // --- DB 접근 시 Mutex로 보호 ---
-                {
-                    std::lock_guard<std::mutex> lock(db_mutex);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 삽입 시작 (Lock 획득)" << endl;
-                    mappingSuccess = insert_data_lines(db,index,x1,y1,x2,y2,name,mode,leftMatrixNum,rightMatrixNum);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 삽입 완료 (Lock 해제)" << endl;
-                }
-                // --- 보호 끝 ---
-
-                json root;
-                root["request_id"] = 11;
-                root["mapping_success"] = (mappingSuccess == true)?1:0;
-                json_string = root.dump();
-                
-                uint32_t res_len = json_string.length();
-                uint32_t net_res_len = htonl(res_len);
-                sendAll(ssl, reinterpret_cast<const char*>(&net_res_len), sizeof(net_res_len), 0);
-                sendAll(ssl, json_string.c_str(), res_len, 0);
-   
-                cout << "[Thread " << std::this_thread::get_id() << "] 응답 전송 완료." << endl;
-
-            } 
-            
-            else if(received_json.value("request_id", -1) == 3){
-                // 클라이언트의 감지선 좌표값 요청(select all) 신호 
-                // getLine해서 기존 라인 정보 들고오기
-                // db의 select all해서 라인 정보 들고오기
-
-                // db에는 delete all하고 일치하는 부분만 다시 insert 
-                // 패킷은 일치하는 것만 전송
-
-                vector<CrossLine> httpLines;
-                // 3. JSON 문자열 파싱
-                json j = json::parse(getLines());
-
-                // 4. 데이터 추출 및 벡터에 추가
-                // "lineCrossing" 배열의 첫 번째 요소 안에 있는 "line" 배열을 순회
-                for (const auto& item : j["lineCrossing"][0]["line"]) {
-                    CrossLine cl; // 임시 CrossLine 객체 생성
-
-                    // 각 필드 값 추출
-                    cl.index = item["index"];
-                    cl.name = item["name"];
-                    cl.mode = item["mode"];
-
-                    // lineCoordinates 배열에서 좌표 추출
-                    cl.x1 = item["lineCoordinates"][0]["x"];
-                    cl.y1 = item["lineCoordinates"][0]["y"];
-                    cl.x2 = item["lineCoordinates"][1]["x"];
-                    cl.y2 = item["lineCoordinates"][1]["y"];
-
-                    // 완성된 객체를 벡터에 추가
-                    httpLines.push_back(cl);
-                }
-
-                
-
-                vector<CrossLine> dbLines;
-                // --- DB 접근 시 Mutex로 보호 ---
-                {
-                    std::lock_guard<std::mutex> lock(db_mutex);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 조회 시작 (Lock 획득)" << endl;
-                    dbLines = select_all_data_lines(db);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 조회 완료 (Lock 해제)" << endl;
-                }
-                // --- 보호 끝 ---
-
-                vector<CrossLine> realLines;
-                for(auto httpLine:httpLines){
-                    for(auto dbLine:dbLines){
-                        if(httpLine.index == dbLine.index){
-                            realLines.push_back(dbLine);
-                        }
-                    }
-                }
-
-                // lines 테이블 비우고 실제 CCTV에 있는 가상선으로만 DB 채우기
-                {
-                    std::lock_guard<std::mutex> lock(db_mutex);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 삭제 시작 (Lock 획득)" << endl;
-                    delete_all_data_lines(db);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 삭제 완료 (Lock 해제)" << endl;
-                }
-                for(auto realLine:realLines){
-                    {
-                        std::lock_guard<std::mutex> lock(db_mutex);
-                        cout << "[Thread " << std::this_thread::get_id() << "] DB 삽입 시작 (Lock 획득)" << endl;
-                        insert_data_lines(db,realLine.index,realLine.x1,realLine.y1,realLine.x2,realLine.y2,realLine.name,realLine.mode,realLine.leftMatrixNum,realLine.rightMatrixNum);
-                        cout << "[Thread " << std::this_thread::get_id() << "] DB 삽입 완료 (Lock 해제)" << endl;
-                    }
-                }
-
-                json root;
-                root["request_id"] = 12;
-                json data_array = json::array();
-                for (const auto& line : realLines) {
-                    json d_obj;
-                    d_obj["index"] = line.index;
-                    d_obj["x1"] = line.x1;
-                    d_obj["y1"] = line.y1;
-                    d_obj["x2"] = line.x2;
-                    d_obj["y2"] = line.y2;
-                    d_obj["name"] = line.name;
-                    d_obj["mode"] = line.mode;
-                    d_obj["right_matrix_num"] = line.rightMatrixNum;
-                    d_obj["left_matrix_num"] = line.leftMatrixNum;
-                    data_array.push_back(d_obj);
-                }
-                root["data"] = data_array;
-                json_string = root.dump();
-                
-                uint32_t res_len = json_string.length();
-                uint32_t net_res_len = htonl(res_len);
-                sendAll(ssl, reinterpret_cast<const char*>(&net_res_len), sizeof(net_res_len), 0);
-                sendAll(ssl, json_string.c_str(), res_len, 0);
-                cout << "[Thread " << std::this_thread::get_id() << "] 응답 전송 완료." << endl;
-            } 
-            
-            else if(received_json.value("request_id", -1) == 4){
-                // 클라이언트에게 보낼 라인 전체 삭제 신호
-                // getLines로 라인들 인덱스 들고오기
-                // cctv에선 들고온 인덱스로 deleteline(index) 반복 호출해서 삭제
-                // db에선 delete_all 호출해서 전부 삭제
-
-                vector<int> indexs;
-                json j = json::parse(getLines());
-
-                for (const auto& item : j["lineCrossing"][0]["line"]) {
-                    indexs.push_back(item["index"]);
-                }
-
-                for(int index:indexs){
-                    deleteLines(index);
-                }
-
-                bool deleteSuccess;
-                // --- DB 접근 시 Mutex로 보호 ---
-                {
-                    std::lock_guard<std::mutex> lock(db_mutex);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 조회 시작 (Lock 획득)" << endl;
-                    deleteSuccess = delete_all_data_lines(db);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 조회 완료 (Lock 해제)" << endl;
-                }
-                // --- 보호 끝 ---
-
-                json root;
-                root["request_id"] = 13;
-                root["delete_success"] = (deleteSuccess==true)?1:0;
-                json_string = root.dump();
-                
-                uint32_t res_len = json_string.length();
-                uint32_t net_res_len = htonl(res_len);
-                sendAll(ssl, reinterpret_cast<const char*>(&net_res_len), sizeof(net_res_len), 0);
-                sendAll(ssl, json_string.c_str(), res_len, 0);
-                cout << "[Thread " << std::this_thread::get_id() << "] 응답 전송 완료." << endl;
+// --- 썸네일 백필 ---
+// 썸네일이 없는 감지 결과(썸네일 도입 전 행, 생성에 실패했던 행)의 썸네일 생성, 백그라운드 스레드에서 실행
+// 원본은 이미지 저장소에서 바로 읽고, DB 연결은 목록 조회와 기록하는 동안만 빌림 (요청 처리를 오래 막지 않음)
+static void backfill_thumbnails(DbPool& db_pool, const ImageStore& image_store, const ThumbnailOptions& options, const atomic<bool>& stopping) {
+    int64_t after_id = 0;
+    int generated = 0;
+    try {
+        while (!stopping) {
+            vector<DetectionRef> batch;
+            {
+                DbConnection reader = db_pool.acquire_reader();
+                batch = select_refs_missing_thumbnail_detections(*reader, after_id, THUMBNAIL_BACKFILL_BATCH);
             }
-
-            else if(received_json.value("request_id", -1) == 5){
-                // 클라이언트의 도로기준선 insert 신호
-                int index = received_json["data"].value("index",-1);
-                int matrixNum1 = received_json["data"].value("matrixNum1", -1);
-                int x1 = received_json["data"].value("x1", -1);
-                int y1 = received_json["data"].value("y1", -1);
-                int matrixNum2 = received_json["data"].value("matrixNum2", -1);
-                int x2 = received_json["data"].value("x2", -1);
-                int y2 = received_json["data"].value("y2", -1);
-
-                BaseLine baseLine = {index, matrixNum1,x1,y1, matrixNum2, x2, y2};
-
-                bool insertSuccess;
-                // --- DB 접근 시 Mutex로 보호 ---
-                {
-                    std::lock_guard<std::mutex> lock(db_mutex);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 삽입 시작 (Lock 획득)" << endl;
-                    insertSuccess = insert_data_baseLines(db,baseLine);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 삽입 완료 (Lock 해제)" << endl;
-                }
-                // --- 보호 끝 ---
-
-                json root;
-                root["request_id"] = 14;
-                root["insert_success"] = (insertSuccess == true)?1:0;
-                json_string = root.dump();
-                
-                uint32_t res_len = json_string.length();
-                uint32_t net_res_len = htonl(res_len);
-                sendAll(ssl, reinterpret_cast<const char*>(&net_res_len), sizeof(net_res_len), 0);
-                sendAll(ssl, json_string.c_str(), res_len, 0);
-                cout << "[Thread " << std::this_thread::get_id() << "] 응답 전송 완료." << endl;
-            } 
-            
-            else if(received_json.value("request_id", -1) == 6){
-                // 클라이언트 감지선의 수직선 방정식 insert 신호 
-                int index = received_json["data"].value("index", -1);
-                double a = received_json["data"].value("a", -1.0); // ax+b = y
-                double b = received_json["data"].value("b", -1.0);
-
-                // VerticalLineEquation verticalLineEquation = {index,a,b};
-
-                bool insertSuccess;
-                // --- DB 접근 시 Mutex로 보호 ---
-                {
-                    std::lock_guard<std::mutex> lock(db_mutex);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 삽입 시작 (Lock 획득)" << endl;
-                    insertSuccess = insert_data_verticalLineEquations(db,index,a,b);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 삽입 완료 (Lock 해제)" << endl;
+            if (batch.empty()) break;
+            after_id = batch.back().id;
+
+            vector<DetectionRef> thumbnails;
+            vector<vector<unsigned char>> thumbnail_images; // 기록할 때 파일이 지워졌으면 다시 쓰기 위해 보관
+            for (const auto& detection : batch) {
+                if (stopping) return;
+                // 아직 BLOB 으로 남은 이미지는 이미지 저장소로 옮겨진 뒤에 처리
+                if (detection.imageHash.empty() || detection.imageSize <= 0) continue;
+                try {
+                    MappedImage image = image_store.open(detection.imageHash);
+                    vector<unsigned char> thumbnail;
+                    if (!make_thumbnail(image.data(), image.size(), options, thumbnail)) continue;
+                    DetectionRef done = detection;
+                    done.thumbHash = image_store.put(thumbnail);
+                    done.thumbSize = thumbnail.size();
+                    thumbnails.push_back(done);
+                    thumbnail_images.push_back(move(thumbnail));
+                } catch (const exception& e) {
+                    LOG_WARN("썸네일 생성 실패 (id: " << detection.id << "): " << e.what());
                 }
-                // --- 보호 끝 ---
-
-                json root;
-                root["request_id"] = 14;
-                root["insert_success"] = (insertSuccess == true)?1:0;
-                json_string = root.dump();
-                
-                uint32_t res_len = json_string.length();
-                uint32_t net_res_len = htonl(res_len);
-                sendAll(ssl, reinterpret_cast<const char*>(&net_res_len), sizeof(net_res_len), 0);
-                sendAll(ssl, json_string.c_str(), res_len, 0);
-                cout << "[Thread " << std::this_thread::get_id() << "] 응답 전송 완료." << endl;
-            } 
-            
-            else if(received_json.value("request_id", -1) == 7){
-                // 클라이언트 도로기준선 select all(동기화) 신호
-
-                vector<BaseLine> baseLines;
-                // --- DB 접근 시 Mutex로 보호 ---
-                {
-                    std::lock_guard<std::mutex> lock(db_mutex);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 조회 시작 (Lock 획득)" << endl;
-                    baseLines = select_all_data_baseLines(db);
-                    cout << "[Thread " << std::this_thread::get_id() << "] DB 조회 완료 (Lock 해제)" << endl;
-                }
-                // --- 보호 끝 ---
-
-                json root;
-                root["request_id"] = 15;
-                json data_array = json::array();
-                for (const auto& baseLine : baseLines) {
-                    json d_obj;
-                    d_obj["index"] = baseLine.index;
-                    d_obj["matrixNum1"] = baseLine.matrixNum1;
-                    d_obj["x1"] = baseLine.x1;
-                    d_obj["y1"] = baseLine.y1;
-                    d_obj["matrixNum2"] = baseLine.matrixNum2;
-                    d_obj["x2"] = baseLine.x2;
-                    d_obj["y2"] = baseLine.y2;
-                    data_array.push_back(d_obj);
-                }
-                root["data"] = data_array;
-                json_string = root.dump();
-                
-                uint32_t res_len = json_string.length();
-                uint32_t net_res_len = htonl(res_len);
-                sendAll(ssl, reinterpret_cast<const char*>(&net_res_len), sizeof(net_res_len), 0);
-                sendAll(ssl, json_string.c_str(), res_len, 0);
-                cout << "[Thread " << std::this_thread::get_id() << "] 응답 전송 완료." << endl;
             }
-
-            cout << "송신 성공 : (" << json_string.size() << " 바이트):\n" << json_string.substr(0,100) << " # 이후 데이터 출력 생략"<< endl;
-        } catch (const json::parse_error& e) {
-            cerr << "[Thread " << std::this_thread::get_id() << "] JSON 파싱 에러: " << e.what() << endl;
+            if (thumbnails.empty()) continue;
+
+            // 쓰기 잠금을 먼저 잡고 파일을 확인한 뒤 기록 (보존 기간 정리와 같은 썸네일이 겹친 경우)
+            DbConnection writer = db_pool.acquire_writer();
+            SQLite::Transaction transaction(*writer, SQLite::TransactionBehavior::IMMEDIATE);
+            for (size_t i = 0; i < thumbnails.size(); i++) {
+                image_store.ensure(thumbnails[i].thumbHash, thumbnail_images[i]);
+                update_thumbnail_detections(*writer, thumbnails[i].id, thumbnails[i].thumbHash, thumbnails[i].thumbSize);
+            }
+            transaction.commit();
+            generated += thumbnails.size();
         }
+    } catch (const exception& e) {
+        LOG_ERROR("썸네일 백필 중단: " << e.what());
+    }
+    if (generated > 0) {
+        LOG_INFO("기존 감지 결과 썸네일 " << generated << "건 생성");
     }
-
-    close(client_socket);
-    printNowTimeKST();
-    cout << " [Thread " << std::this_thread::get_id() << "] 클라이언트 연결 종료 및 스레드 정리." << endl;
 }
 
-
-// --- 메인 TCP 서버 로직 (수정됨) ---
+// --- 메인 TCP 서버 로직 (epoll 이벤트 루프) ---
 int tcp_run() {
     // OpenSSL 초기화
     if (!init_openssl()) {
-        cerr << "OpenSSL 초기화 실패" << endl;
+        LOG_ERROR("OpenSSL 초기화 실패");
         return -1;
     }
 
@@ -767,144 +544,94 @@ int tcp_run() {
     // SSL 컨텍스트 설정
     configure_ssl_context(ssl_ctx);
 
-    SQLite::Database db("server_log.db", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
-    cout << "데이터베이스 파일 'server_log.db'에 연결되었습니다.\n";
+    // 요청 처리(DB 조회, curl 통신, 인코딩)는 고정 크기 워커 풀에서 수행
+    size_t worker_count = thread::hardware_concurrency();
+    if (worker_count == 0) worker_count = WORKER_THREADS_DEFAULT;
+
+    // WAL 모드 연결 풀: 워커마다 읽기 연결 하나씩 + 쓰기 연결 하나 (읽기 요청끼리는 서로 기다리지 않음)
+    DbPool db_pool("server_log.db", worker_count);
+    LOG_INFO("데이터베이스 파일 'server_log.db'에 연결되었습니다.");
+
+    // 감지 이미지는 DB 밖의 이미지 저장소에 해시 이름 파일로 저장
+    ImageStore image_store(IMAGE_STORE_DIR);
+
+    // 테이블/인덱스 생성은 시작 시 한 번만 (연결마다 DDL 을 실행하지 않음)
+    {
+        DbConnection writer = db_pool.acquire_writer();
+        if (!migrate_schema(*writer)) {
+            LOG_ERROR("DB 스키마 마이그레이션 실패");
+            return -1;
+        }
+
+        // 이전 버전에서 DB 에 BLOB 으로 저장된 이미지를 저장소로 이동 (옮길 것이 없으면 바로 끝남)
+        try {
+            int moved = migrate_images_to_store(*writer, image_store);
+            if (moved > 0) {
+                LOG_INFO("감지 이미지 " << moved << "건을 이미지 저장소로 옮겼습니다.");
+            }
+        } catch (const exception& e) {
+            LOG_ERROR("이미지 저장소 이동 실패 (남은 이미지는 DB 에서 계속 제공): " << e.what());
+        }
+
+        // request_id 3, 7 은 DB 대신 설정 캐시에서 읽음 (이후 변경은 db_management 의 쓰기 함수가 반영)
+        config_cache().load(*writer);
+
+        // 지운 행의 빈 페이지를 유지보수 스레드가 조금씩 반환할 수 있도록 전환 (처음 한 번만 VACUUM, 옮긴 BLOB 공간도 이때 반환됨)
+        if (!enable_incremental_vacuum(*writer)) {
+            LOG_WARN("incremental vacuum 을 사용할 수 없어 DB 파일 크기가 줄지 않습니다.");
+        }
+    }
 
     // 1. libcurl 전역 초기화
     // 프로그램 시작 시 한 번만 호출하면 돼요.
     CURLcode res_global_init = curl_global_init(CURL_GLOBAL_DEFAULT);
     if (res_global_init != CURLE_OK) {
-        std::cerr << "curl_global_init() 실패: " << curl_easy_strerror(res_global_init) << std::endl;
+        LOG_ERROR("curl_global_init() 실패: " << curl_easy_strerror(res_global_init));
         return -1;
     }
-    
-    std::mutex db_mutex; // DB 접근을 보호할 뮤텍스 객체
-
-    int server_fd;
-    struct sockaddr_in address;
-    socklen_t addrlen = sizeof(address);
-
-    server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(PORT);
-    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) { cerr << "Bind Failed" << endl; return -1; }
-    if (listen(server_fd, 10) < 0) { cerr << "Listen Failed" << endl; return -1; }
-    
-    printNowTimeKST();
-    cout << " 멀티스레드 서버 시작. 클라이언트 연결 대기 중... (Port: " << PORT << ")" << endl;
-
-    while (true) {
-        int new_socket = accept(server_fd, (struct sockaddr *)&address, &addrlen);
-        if (new_socket < 0) {
-            cerr << "연결 수락 실패" << endl;
-            continue;
-        }
-        
-        printNowTimeKST();
-        cout << " 메인 스레드: 클라이언트 연결 수락됨. 처리 스레드 생성..." << endl;
 
-        // 새 클라이언트를 처리할 스레드 생성 및 분리
-        std::thread client_thread(handle_client, new_socket, std::ref(db), std::ref(db_mutex));
-        client_thread.detach(); // 메인 스레드는 기다리지 않고 바로 다음 클라이언트를 받으러 감
-    }
+    // 끊어진 소켓에 SSL_write 할 때 SIGPIPE 로 프로세스가 종료되지 않도록 무시
+    signal(SIGPIPE, SIG_IGN);
 
-    close(server_fd);
-    curl_global_cleanup();
-    return 0;
-}
+    // 목록 조회(thumbnails)용 썸네일 설정, 썸네일이 없는 기존 행은 서버 실행 중 백그라운드로 생성
+    ThumbnailOptions thumbnail_options = thumbnail_options_from_env();
+    LOG_INFO("썸네일 설정: 최대 너비 " << thumbnail_options.max_width << "px, 품질 " << thumbnail_options.quality);
+    atomic<bool> stopping_backfill{false};
+    thread thumbnail_backfill(backfill_thumbnails, ref(db_pool), cref(image_store), cref(thumbnail_options), cref(stopping_backfill));
 
-// SSL 버전의 송수신 함수
-bool recvAll(SSL* ssl, char* buffer, size_t len) {
-    size_t total_received = 0;
-    while (total_received < len) {
-        int bytes_received = SSL_read(ssl, buffer + total_received, len - total_received);
-        
-        if (bytes_received <= 0) {
-            int error = SSL_get_error(ssl, bytes_received);
-            if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
-                continue;
-            }
-            ERR_print_errors_fp(stderr);
-            return false;
-        }
-        total_received += bytes_received;
-    }
-    return true;
-}
+    // 보존 기간이 지난 감지 결과를 하루 단위로 지우고 DB 빈 페이지를 조금씩 반환 (소멸 시 스레드 종료)
+    DbMaintenance db_maintenance(db_pool, image_store, retention_options_from_env());
 
-ssize_t sendAll(SSL* ssl, const char* buffer, size_t len, int flags) {
-    size_t total_sent = 0;
-    while (total_sent < len) {
-        int bytes_sent = SSL_write(ssl, buffer + total_sent, len - total_sent);
+    WorkerPool worker_pool(worker_count, WORKER_QUEUE_SIZE);
 
-        if (bytes_sent <= 0) {
-            int error = SSL_get_error(ssl, bytes_sent);
-            if (error == SSL_ERROR_WANT_WRITE || error == SSL_ERROR_WANT_READ) {
-                continue;
-            }
-            ERR_print_errors_fp(stderr);
-            return -1;
-        }
+    // request_id 별 핸들러 등록 (요청 해석/처리/응답 생성과 처리 지표 집계)
+    RequestDispatcher dispatcher(db_pool, image_store);
+    register_request_handlers(dispatcher);
+
+    // 클라이언트마다 스레드를 만들지 않고 epoll 이벤트 루프 하나에서 모든 연결의 소켓 I/O 를 처리
+    EventLoop event_loop(ssl_ctx, worker_pool, [&](vector<char>&& frame, ResponseWriter& writer) {
+        dispatcher.dispatch(frame, writer);
+    });
 
-        total_sent += bytes_sent;
+    // correlation_id 가 붙은 요청은 앞선 요청의 응답을 기다리지 않고 바로 처리 (응답 순서는 보장하지 않음)
+    event_loop.set_frame_classifier(has_correlation_id);
+
+    if (!event_loop.listen_on(PORT)) {
+        stopping_backfill = true;
+        thumbnail_backfill.join();
+        curl_global_cleanup();
+        return -1;
     }
+    
+    LOG_INFO("epoll 이벤트 루프 서버 시작. 클라이언트 연결 대기 중... (Port: " << PORT << ")");
 
-    return total_sent;
-}
+    event_loop.run();
 
-// 일반 소켓 버전의 송수신 함수
-// bool recvAll(int socket_fd, char* buffer, size_t len) {
-//     size_t total_received = 0;
-//     while (total_received < len) {
-//         ssize_t bytes_received = recv(socket_fd, buffer + total_received, len - total_received, 0);
-        
-//         if (bytes_received == -1) {
-//             if (errno == EINTR) continue;
-//             cerr << "recv 에러: " << strerror(errno) << endl;
-//             return false;
-//         }
-//         if (bytes_received == 0) {
-//             cerr << "데이터 수신 중 클라이언트 연결 종료" << endl;
-//             return false;
-//         }
-//         total_received += bytes_received;
-//     }
-//     return true;
-// }
-
-// ssize_t sendAll(int socket_fd, const char* buffer, size_t len, int flags) {
-//     size_t total_sent = 0;
-//     while (total_sent < len) {
-//         ssize_t bytes_sent = send(socket_fd, buffer + total_sent, len - total_sent, flags);
-
-//         if (bytes_sent == -1) {
-//             if (errno == EINTR) {
-//                 continue;
-//             }
-//             return -1;
-//         }
-
-//         if (bytes_sent == 0) {
-//             return total_sent;
-//         }
-//         total_sent += bytes_sent;
-//     }
-//     return total_sent;
-// }
-
-void printNowTimeKST(){
-    // 한국 시간 (KST), 밀리초 포함 출력
-    chrono::system_clock::time_point now = chrono::system_clock::now();
-    time_t now_c = chrono::system_clock::to_time_t(now);
-    auto duration_since_epoch = now.time_since_epoch();
-    auto milliseconds = chrono::duration_cast<chrono::milliseconds>(duration_since_epoch).count() % 1000;
-    const long KST_OFFSET_SECONDS = 9 * 60 * 60; 
-    time_t kst_now_c = now_c + KST_OFFSET_SECONDS;
-    tm* kst_tm = gmtime(&kst_now_c);
-    cout << "\n["
-            << put_time(kst_tm, "%Y-%m-%d %H:%M:%S") 
-            << "." << setfill('0') << setw(3) << milliseconds << " KST]" << endl;
+    // 이벤트 루프가 끝나면 진행 중인 요청을 마무리하고 워커 정리
+    worker_pool.stop();
+    db_maintenance.stop();
+    stopping_backfill = true;
+    thumbnail_backfill.join();
+    curl_global_cleanup();
+    return 0;
 }
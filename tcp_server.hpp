@@ -10,8 +10,11 @@
 #include <iomanip>
 #include <cstdint> // uint32_t
 #include <thread>
+#include <atomic>
 #include <mutex>
 #include <stdlib.h>
+#include <csignal>
+#include <deque>
 
 // POSIX 소켓 API 관련 헤더
 #include <sys/socket.h> // socket, bind, listen, accept
@@ -33,10 +36,24 @@
 // OpenSSL 관련 헤더
 #include <openssl/ssl.h>
 #include <openssl/err.h>
+#include <openssl/rand.h>
+#include <openssl/evp.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#else
+#include <openssl/hmac.h>
+#endif
 
 extern SSL_CTX* ssl_ctx;
 
 #include "db_management.hpp"
+#include "base64.hpp"
+#include "worker_pool.hpp"
+#include "tcp_event_loop.hpp"
+#include "request_dispatcher.hpp"
+#include "request_handlers.hpp"
+#include "db_maintenance.hpp"
+#include "thumbnail.hpp"
 
 
 using namespace std;
@@ -44,21 +61,32 @@ using json = nlohmann::json;
 
 const int PORT = 8080;
 
-string getLines();
+// 감지 이미지 저장소 디렉터리 (server_log.db 와 같은 위치, 메타데이터 프로세스와 공유)
+const char* const IMAGE_STORE_DIR = "images";
 
-string putLines(CrossLine);
+// 썸네일이 없는 기존 감지 결과를 한 번에 처리하는 행 수 (배치마다 쓰기 연결을 잠깐 빌려 기록)
+const int THUMBNAIL_BACKFILL_BATCH = 16;
 
-string deleteLines(int index);
+// 워커 풀 설정 (스레드 수를 알 수 없을 때의 기본값, 대기열 최대 길이)
+const size_t WORKER_THREADS_DEFAULT = 4;
+const size_t WORKER_QUEUE_SIZE = 64;
 
-string base64_encode(const vector<unsigned char>& in);
+// TLS 세션 재사용 설정 (서버 세션 캐시 크기, 세션 유효 시간(초))
+const char* const TLS_SESSION_ID_CONTEXT = "veda-detection-server";
+const long TLS_SESSION_CACHE_SIZE = 1024;
+const long TLS_SESSION_TIMEOUT = 24 * 60 * 60;
 
-int tcp_run();
+// 세션 티켓 키 교체 주기와 보관 개수 (교체 후에도 이전 키 티켓은 보관 개수만큼 복호화 가능)
+const chrono::hours TICKET_KEY_ROTATION_INTERVAL(6);
+const size_t TICKET_KEY_COUNT = 4;
 
-bool recvAll(SSL*, char* buffer, size_t len);
+string getLines();
 
-ssize_t sendAll(SSL*, const char* buffer, size_t len, int flags);
+string putLines(CrossLine);
+
+string deleteLines(int index);
 
-void printNowTimeKST();
+int tcp_run();
 
 // SSL 초기화 및 정리 함수
 
@@ -0,0 +1,163 @@
+#include "thumbnail.hpp"
+#include "logger.hpp"
+
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <csetjmp>
+
+#include <jpeglib.h>
+
+// libjpeg 오류는 longjmp 로 호출 함수에 돌려보냄 (기본 동작은 exit)
+struct JpegErrorManager {
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+static void jpeg_error_exit(j_common_ptr cinfo) {
+    JpegErrorManager* err = reinterpret_cast<JpegErrorManager*>(cinfo->err);
+    (*cinfo->err->format_message)(cinfo, err->message);
+    longjmp(err->jump, 1);
+}
+
+// 손상된 데이터 경고는 출력하지 않음 (디코딩은 계속 진행됨)
+static void jpeg_ignore_message(j_common_ptr) {}
+
+static int env_int(const char* name, int default_value, int min_value, int max_value) {
+    const char* value = getenv(name);
+    if (!value) return default_value;
+    int parsed = atoi(value);
+    if (parsed < min_value || parsed > max_value) {
+        LOG_WARN(name << " 값이 범위(" << min_value << "~" << max_value << ")를 벗어나 기본값 " << default_value << " 사용");
+        return default_value;
+    }
+    return parsed;
+}
+
+ThumbnailOptions thumbnail_options_from_env() {
+    ThumbnailOptions options;
+    options.max_width = env_int("THUMBNAIL_WIDTH", THUMBNAIL_WIDTH_DEFAULT, 16, 1920);
+    options.quality = env_int("THUMBNAIL_QUALITY", THUMBNAIL_QUALITY_DEFAULT, 1, 100);
+    return options;
+}
+
+// target_width 이상을 유지하는 가장 작은 DCT 스케일(1/8, 1/4, 1/2, 1)로 RGB 디코딩
+static bool decode_scaled(const unsigned char* jpeg, size_t size, int target_width, vector<unsigned char>& rgb, int& width, int& height) {
+    jpeg_decompress_struct cinfo;
+    JpegErrorManager jerr;
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = jpeg_error_exit;
+    jerr.pub.output_message = jpeg_ignore_message;
+    if (setjmp(jerr.jump)) {
+        LOG_WARN("썸네일 디코딩 실패: " << jerr.message);
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(jpeg), size);
+    jpeg_read_header(&cinfo, TRUE);
+
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = 8;
+    while (cinfo.scale_denom > 1 && cinfo.image_width / cinfo.scale_denom < static_cast<unsigned int>(target_width)) {
+        cinfo.scale_denom /= 2;
+    }
+    cinfo.out_color_space = JCS_RGB;
+    cinfo.dct_method = JDCT_IFAST;          // 어차피 다시 축소하므로 빠른 정수 IDCT 사용
+    cinfo.do_fancy_upsampling = FALSE;
+
+    jpeg_start_decompress(&cinfo);
+    width = cinfo.output_width;
+    height = cinfo.output_height;
+    size_t stride = static_cast<size_t>(width) * 3;
+    rgb.resize(stride * height);
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = &rgb[cinfo.output_scanline * stride];
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+// 영역 평균으로 (width x height) → (out_width x out_height) 축소
+static vector<unsigned char> downscale(const vector<unsigned char>& rgb, int width, int height, int out_width, int out_height) {
+    vector<unsigned char> out(static_cast<size_t>(out_width) * out_height * 3);
+    for (int oy = 0; oy < out_height; oy++) {
+        int y0 = oy * height / out_height;
+        int y1 = max(y0 + 1, (oy + 1) * height / out_height);
+        for (int ox = 0; ox < out_width; ox++) {
+            int x0 = ox * width / out_width;
+            int x1 = max(x0 + 1, (ox + 1) * width / out_width);
+            unsigned int sum[3] = {0, 0, 0};
+            for (int y = y0; y < y1; y++) {
+                const unsigned char* p = &rgb[(static_cast<size_t>(y) * width + x0) * 3];
+                for (int x = x0; x < x1; x++, p += 3) {
+                    sum[0] += p[0];
+                    sum[1] += p[1];
+                    sum[2] += p[2];
+                }
+            }
+            unsigned int count = (y1 - y0) * (x1 - x0);
+            unsigned char* q = &out[(static_cast<size_t>(oy) * out_width + ox) * 3];
+            for (int c = 0; c < 3; c++) q[c] = static_cast<unsigned char>((sum[c] + count / 2) / count);
+        }
+    }
+    return out;
+}
+
+static bool encode_jpeg(const vector<unsigned char>& rgb, int width, int height, int quality, vector<unsigned char>& out) {
+    jpeg_compress_struct cinfo;
+    JpegErrorManager jerr;
+    unsigned char* buffer = nullptr;
+    unsigned long length = 0;
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = jpeg_error_exit;
+    if (setjmp(jerr.jump)) {
+        LOG_ERROR("썸네일 인코딩 실패: " << jerr.message);
+        jpeg_destroy_compress(&cinfo);
+        free(buffer);
+        return false;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &buffer, &length);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    size_t stride = static_cast<size_t>(width) * 3;
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = const_cast<unsigned char*>(&rgb[cinfo.next_scanline * stride]);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+
+    out.assign(buffer, buffer + length);
+    free(buffer);
+    return true;
+}
+
+bool make_thumbnail(const unsigned char* jpeg, size_t size, const ThumbnailOptions& options, vector<unsigned char>& out) {
+    if (size == 0) return false;
+
+    vector<unsigned char> rgb;
+    int width = 0, height = 0;
+    if (!decode_scaled(jpeg, size, options.max_width, rgb, width, height)) return false;
+
+    if (width > options.max_width) {
+        int out_width = options.max_width;
+        int out_height = max(1, static_cast<int>((static_cast<long long>(height) * out_width + width / 2) / width));
+        rgb = downscale(rgb, width, height, out_width, out_height);
+        width = out_width;
+        height = out_height;
+    }
+    return encode_jpeg(rgb, width, height, options.quality, out);
+}
@@ -0,0 +1,25 @@
+// 감지 이미지 썸네일 생성 모듈
+// 원본 JPEG(3840x2160)을 libjpeg 의 DCT 스케일링으로 1/2 ~ 1/8 크기로 바로 디코딩한 뒤
+// 지정 너비로 평균 축소하고 다시 JPEG 로 인코딩한다. (원본 해상도 전체를 디코딩하지 않음)
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+// 썸네일 설정 기본값 (환경변수 THUMBNAIL_WIDTH, THUMBNAIL_QUALITY 로 변경 가능)
+const int THUMBNAIL_WIDTH_DEFAULT = 320;
+const int THUMBNAIL_QUALITY_DEFAULT = 70;
+
+struct ThumbnailOptions {
+    int max_width = THUMBNAIL_WIDTH_DEFAULT;   // 썸네일 최대 너비 (높이는 원본 비율 유지)
+    int quality = THUMBNAIL_QUALITY_DEFAULT;   // JPEG 품질 (1~100)
+};
+
+// 환경변수에서 썸네일 설정을 읽음 (없거나 범위를 벗어나면 기본값)
+ThumbnailOptions thumbnail_options_from_env();
+
+// JPEG 이미지의 썸네일(JPEG)을 out 에 생성, JPEG 가 아니거나 손상된 이미지면 false
+bool make_thumbnail(const unsigned char* jpeg, size_t size, const ThumbnailOptions& options, vector<unsigned char>& out);
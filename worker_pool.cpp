@@ -0,0 +1,56 @@
+#include "worker_pool.hpp"
+#include "logger.hpp"
+
+WorkerPool::WorkerPool(size_t num_threads, size_t max_queue)
+    : max_queue(max_queue) {
+    if (num_threads == 0) num_threads = 1;
+    for (size_t i = 0; i < num_threads; i++) {
+        workers.emplace_back(&WorkerPool::worker_loop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+void WorkerPool::stop() {
+    {
+        lock_guard<mutex> lock(jobs_mutex);
+        stopping = true;
+    }
+    jobs_cv.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+bool WorkerPool::try_submit(function<void()> job) {
+    {
+        lock_guard<mutex> lock(jobs_mutex);
+        if (stopping || jobs.size() >= max_queue) {
+            return false;
+        }
+        jobs.push_back(move(job));
+    }
+    jobs_cv.notify_one();
+    return true;
+}
+
+void WorkerPool::worker_loop() {
+    while (true) {
+        function<void()> job;
+        {
+            unique_lock<mutex> lock(jobs_mutex);
+            jobs_cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty()) return;
+            job = move(jobs.front());
+            jobs.pop_front();
+        }
+
+        try {
+            job();
+        } catch (const exception& e) {
+            LOG_ERROR("[Worker " << this_thread::get_id() << "] 작업 처리 중 예외 발생: " << e.what());
+        }
+    }
+}
@@ -0,0 +1,42 @@
+// 고정 크기 워커 스레드 풀 모듈
+// 소켓 I/O(이벤트 루프)와 요청 처리(JSON 파싱, DB 조회, curl 통신, 인코딩)를 분리하기 위해 사용
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+class WorkerPool {
+public:
+    // num_threads 개의 워커 스레드와 최대 max_queue 개의 대기 작업을 가지는 풀 생성
+    WorkerPool(size_t num_threads, size_t max_queue);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // 대기열이 가득 차 있으면 작업을 넣지 않고 false 반환 (호출 스레드를 막지 않음)
+    bool try_submit(function<void()> job);
+
+    // 남은 작업을 모두 처리한 뒤 워커 스레드 종료 (소멸자에서도 호출됨)
+    void stop();
+
+    size_t size() const { return workers.size(); }
+
+private:
+    vector<thread> workers;
+    deque<function<void()>> jobs;
+    size_t max_queue;
+    bool stopping = false;
+
+    mutex jobs_mutex;
+    condition_variable jobs_cv;
+
+    void worker_loop();
+};